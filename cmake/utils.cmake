@@ -64,6 +64,39 @@ function(hy_get_dist_name retval)
 endfunction()
 
 
+# Builds tests/<name>_test.cpp against the sources in src/ and registers it with CTest. Extra arguments are linked.
+function(hy_add_test _name)
+    string(REPLACE "_" "-" _target "${PROJECT_NAME}-${_name}-test")
+
+    add_executable(${_target})
+    target_sources(${_target} PRIVATE
+        "${CMAKE_CURRENT_SOURCE_DIR}/tests/${_name}_test.cpp"
+    )
+    target_compile_features(${_target} PRIVATE cxx_std_20)
+
+    target_include_directories(${_target} PRIVATE
+        "${CMAKE_CURRENT_SOURCE_DIR}/include"
+        "${CMAKE_CURRENT_SOURCE_DIR}/src"
+        "${CMAKE_CURRENT_SOURCE_DIR}/vendor/include"
+        "${CMAKE_CURRENT_BINARY_DIR}/generated/include"
+    )
+
+    target_link_libraries(${_target} PRIVATE
+        fmt::fmt
+        spdlog::spdlog
+        ${ARGN}
+    )
+
+    if (MSVC)
+        target_compile_options(${_target} PRIVATE
+            "/utf-8"
+        )
+    endif()
+
+    add_test(NAME ${_name} COMMAND ${_target})
+endfunction()
+
+
 # include(CheckCSourceCompiles)
 
 
@@ -0,0 +1,133 @@
+/* Copyright (c) 2025 Hygor Ostrowskij de Morais <hygor.o.morais@gmail.com> */
+
+/*
+ * In-process API for applying the Interception Driver fix without spawning interception-driver-fix.exe.
+ *
+ * All structs carry their own size so that fields can be appended without breaking older callers:
+ * only the fields that fit in the caller's size are read or written.
+ * Call idf_config_init() before filling in a config.
+ */
+
+#ifndef INTERCEPTION_DRIVER_FIX_H
+#define INTERCEPTION_DRIVER_FIX_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32) && defined(IDF_SHARED)
+#  if defined(IDF_BUILDING_LIBRARY)
+#    define IDF_API __declspec(dllexport)
+#  else
+#    define IDF_API __declspec(dllimport)
+#  endif
+#elif defined(IDF_SHARED)
+#  define IDF_API __attribute__((visibility("default")))
+#else
+#  define IDF_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#define IDF_ABI_VERSION 1
+
+
+typedef enum idf_status {
+    IDF_OK            = 0,
+    IDF_ERROR         = 1,  /* The repair failed, see idf_result.message. */
+    IDF_INVALID_ARG   = 2,
+    IDF_NOT_AVAILABLE = 3,  /* Nothing has been published since boot, or the publisher died mid-write. */
+} idf_status;
+
+
+typedef enum idf_log_level {
+    IDF_LOG_TRACE     = 0,
+    IDF_LOG_DEBUG     = 1,
+    IDF_LOG_INFO      = 2,
+    IDF_LOG_WARN      = 3,
+    IDF_LOG_ERROR     = 4,
+    IDF_LOG_CRITICAL  = 5,
+} idf_log_level;
+
+
+typedef struct idf_config {
+    uint32_t size;  /* sizeof(idf_config) */
+    int32_t verbose;
+    int32_t lockdown;
+    int32_t max_interception_devices;
+    int32_t keyboard_symlinks;
+    int32_t pointer_symlinks;
+} idf_config;
+
+
+typedef struct idf_result {
+    uint32_t size;  /* sizeof(idf_result) */
+    int32_t status;  /* idf_status */
+    int32_t devices;
+    int32_t symlinks_created;
+    int32_t symlinks_existing;
+    int32_t symlinks_name_taken;
+    uint64_t duration_ns;
+    char message[256];  /* Null terminated error message, empty on success. */
+} idf_result;
+
+
+/* Consistent copy of the status block the service publishes after every apply. */
+typedef struct idf_status_snapshot {
+    uint32_t size;  /* sizeof(idf_status_snapshot) */
+    uint32_t error_count;
+    uint64_t generation;  /* Number of applies since boot. */
+    int64_t last_apply_unix_ns;
+    int64_t last_apply_duration_ns;
+    int32_t lockdown;
+    int32_t max_interception_devices;
+    int32_t keyboard_symlinks;
+    int32_t pointer_symlinks;
+    int32_t symlinks_created;
+    int32_t symlinks_existing;
+    int32_t symlinks_name_taken;
+} idf_status_snapshot;
+
+
+/* Called synchronously from the calling thread. msg is only valid for the duration of the call. */
+typedef void (*idf_log_fn)(void* user_data, idf_log_level level, const char* msg, size_t msg_len);
+
+/* Called once per metric after a repair, e.g. ("symlinks_created", 1980). */
+typedef void (*idf_metric_fn)(void* user_data, const char* name, double value);
+
+
+typedef struct idf_callbacks {
+    uint32_t size;  /* sizeof(idf_callbacks) */
+    idf_log_fn log;        /* Optional */
+    idf_metric_fn metric;  /* Optional */
+    void* user_data;
+} idf_callbacks;
+
+
+IDF_API uint32_t idf_abi_version(void);
+
+/* Fills in the defaults. Use idf_config_init, which passes the size of the caller's idf_config. */
+IDF_API idf_status idf_config_init_sized(idf_config* cfg, size_t size);
+
+static inline idf_status idf_config_init(idf_config* cfg) {
+    return idf_config_init_sized(cfg, sizeof(idf_config));
+}
+
+/* Applies the fix in-process. Returns the same value stored in result->status. result and callbacks are optional.
+ * On Windows the symlinks are created with OBJ_PERMANENT, so SeCreatePermanentPrivilege must be enabled in the calling
+ * thread's token beforehand, otherwise this fails with STATUS_PRIVILEGE_NOT_HELD (0xC0000061). Setting the Interception
+ * device DACLs needs Administrator rights. */
+IDF_API idf_status idf_repair(const idf_config* cfg, const idf_callbacks* callbacks, idf_result* result);
+
+/* Reads the shared status block. The block is mapped on first use, later calls do not enter the kernel.
+ * Never blocks: a block left mid-write by a crashed service reads as IDF_NOT_AVAILABLE until the next apply. */
+IDF_API idf_status idf_read_status(idf_status_snapshot* snapshot);
+
+
+#ifdef __cplusplus
+}  /* extern "C" */
+#endif
+
+#endif  /* INTERCEPTION_DRIVER_FIX_H */
@@ -0,0 +1,146 @@
+// Copyright (c) 2025 Hygor Ostrowskij de Morais <hygor.o.morais@gmail.com>
+
+// Replaces the global allocation functions to count heap use in ResourceCounters.
+//   Linked into the executables only, never into the library. Kept out of line so the replacements
+//   can't be inlined into callers.
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+#include "instrumentation.hpp"
+
+
+namespace {
+
+
+void count_alloc(std::size_t size) {
+    auto& c = hy::resource_counters();
+    c.allocations.fetch_add(1, std::memory_order_relaxed);
+    c.allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+
+void count_free() {
+    hy::resource_counters().deallocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+
+// Retries through the new handler until alloc succeeds, like the default operator new.
+template<typename Alloc>
+void* counted_alloc(std::size_t size, Alloc alloc) {
+    for (;;) {
+        if (auto p = alloc()) {
+            count_alloc(size);
+            return p;
+        }
+        auto handler = std::get_new_handler();
+        if (!handler) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+
+void* counted_alloc(std::size_t size) {
+    return counted_alloc(size, [&] { return std::malloc(size ? size : 1); });
+}
+
+
+void counted_free(void* p) {
+    if (!p) {
+        return;
+    }
+    count_free();
+    std::free(p);
+}
+
+
+void* counted_aligned_alloc(std::size_t size, std::align_val_t align) {
+    auto alignment = static_cast<std::size_t>(align);
+    return counted_alloc(size, [&] {
+#ifdef _WIN32
+        return _aligned_malloc(size ? size : 1, alignment);
+#else
+        // aligned_alloc wants a nonzero multiple of the alignment.
+        auto rounded = (std::max(size, alignment) + alignment - 1) / alignment * alignment;
+        return std::aligned_alloc(alignment, rounded);
+#endif
+    });
+}
+
+
+void counted_aligned_free(void* p) {
+    if (!p) {
+        return;
+    }
+    count_free();
+#ifdef _WIN32
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+
+[[maybe_unused]] const bool allocation_hooks_installed = [] {
+    hy::resource_counters().allocation_hooks_installed = true;
+    return true;
+}();
+
+
+}  // namespace
+
+
+void* operator new(std::size_t size) {
+    return counted_alloc(size);
+}
+
+void* operator new[](std::size_t size) {
+    return ::operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return counted_alloc(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept {
+    return ::operator new(size, tag);
+}
+
+void* operator new(std::size_t size, std::align_val_t align) {
+    return counted_aligned_alloc(size, align);
+}
+
+void* operator new[](std::size_t size, std::align_val_t align) {
+    return ::operator new(size, align);
+}
+
+void* operator new(std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    try {
+        return counted_aligned_alloc(size, align);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, std::align_val_t align, const std::nothrow_t& tag) noexcept {
+    return ::operator new(size, align, tag);
+}
+
+void operator delete(void* p) noexcept                                                { counted_free(p); }
+void operator delete[](void* p) noexcept                                              { counted_free(p); }
+void operator delete(void* p, std::size_t) noexcept                                   { counted_free(p); }
+void operator delete[](void* p, std::size_t) noexcept                                 { counted_free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept                         { counted_free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept                       { counted_free(p); }
+void operator delete(void* p, std::align_val_t) noexcept                              { counted_aligned_free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept                            { counted_aligned_free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept                 { counted_aligned_free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept               { counted_aligned_free(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept       { counted_aligned_free(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept     { counted_aligned_free(p); }
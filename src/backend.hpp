@@ -0,0 +1,73 @@
+// Copyright (c) 2025 Hygor Ostrowskij de Morais <hygor.o.morais@gmail.com>
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <fmt/format.h>
+
+
+namespace hy {
+
+
+enum class SymlinkStatus {
+    created,
+    already_exists,  // A symlink object with the same link name already exists.
+    name_taken,      // A non-symlink object with the same link name already exists.
+};
+
+
+// An object manager call failed with an unexpected NTSTATUS.
+class NtStatusError : public std::runtime_error {
+public:
+    NtStatusError(const std::string& what, uint32_t status) : std::runtime_error(what), status_(status) {}
+
+    uint32_t status() const { return status_; }
+
+private:
+    uint32_t status_;
+};
+
+
+inline NtStatusError nt_status_error(const char* function, int32_t status) {
+    return NtStatusError(fmt::format("{} error (0x{:x}).", function, static_cast<uint32_t>(status)), static_cast<uint32_t>(status));
+}
+
+
+enum class ObjectType {
+    device,
+    symbolic_link,
+    directory,
+    other,
+};
+
+
+struct DirectoryEntry {
+    std::string name;  // Relative to the queried directory.
+    ObjectType type;
+};
+
+
+// Object manager operations needed by real_main.
+//   NtNamespaceBackend talks to the real \Device directory, SimNamespaceBackend keeps an in-memory copy of it.
+struct NamespaceBackend {
+    virtual ~NamespaceBackend() = default;
+
+    virtual SymlinkStatus create_symlink(const std::string& link, const std::string& target) = 0;
+    virtual void remove_symlink(const std::string& link) = 0;
+    virtual void set_interception_device_permissions(int idx, const std::string& sddl) = 0;
+
+    // Read-only queries, used by verify. Implementations may reuse internal buffers between calls.
+    virtual std::vector<DirectoryEntry> list_directory(const std::string& path) = 0;
+    virtual std::optional<std::string> query_symlink(const std::string& link) = 0;
+    // Empty optional if the device doesn't exist.
+    virtual std::optional<std::string> query_interception_device_sddl(int idx) = 0;
+    // Brings an SDDL string to the form query_interception_device_sddl returns, so both can be compared.
+    virtual std::string normalize_sddl(const std::string& sddl) { return sddl; }
+};
+
+
+}  // namespace
@@ -0,0 +1,59 @@
+// Copyright (c) 2025 Hygor Ostrowskij de Morais <hygor.o.morais@gmail.com>
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+#include <spdlog/sinks/null_sink.h>
+
+
+namespace hy {
+
+
+// The benches run the real code paths, which log. Nothing of that is wanted in their reports.
+inline std::shared_ptr<spdlog::logger> make_null_logger(std::string name) {
+    return std::make_shared<spdlog::logger>(std::move(name), std::make_shared<spdlog::sinks::null_sink_st>());
+}
+
+
+inline std::chrono::nanoseconds percentile(const std::vector<std::chrono::nanoseconds>& sorted, double p) {
+    if (sorted.empty()) {
+        return {};
+    }
+    // Nearest rank.
+    auto rank = static_cast<size_t>(std::ceil(p / 100.0 * sorted.size()));
+    return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
+
+
+struct DurationSummary {
+    std::chrono::nanoseconds p50;
+    std::chrono::nanoseconds p99;
+    std::chrono::nanoseconds max;
+};
+
+
+// Sorts durations.
+inline DurationSummary summarize_durations(std::vector<std::chrono::nanoseconds>& durations) {
+    std::sort(durations.begin(), durations.end());
+    return {
+        percentile(durations, 50),
+        percentile(durations, 99),
+        durations.empty() ? std::chrono::nanoseconds() : durations.back(),
+    };
+}
+
+
+// The "p50_ns", "p99_ns" and "max_ns" members of a JSON object.
+inline std::string format_duration_summary(const DurationSummary& s) {
+    return fmt::format(R"("p50_ns":{},"p99_ns":{},"max_ns":{})", s.p50.count(), s.p99.count(), s.max.count());
+}
+
+
+}  // namespace
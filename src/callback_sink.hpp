@@ -0,0 +1,42 @@
+// Copyright (c) 2025 Hygor Ostrowskij de Morais <hygor.o.morais@gmail.com>
+
+#pragma once
+
+#include <functional>
+#include <mutex>
+#include <spdlog/sinks/base_sink.h>
+
+
+namespace hy {
+
+
+// Forwards formatted log lines to a callback. spdlog only ships callback_sink from 1.12 onwards.
+template<typename Mutex>
+class callback_sink : public spdlog::sinks::base_sink<Mutex> {
+public:
+    using callback_t = std::function<void(spdlog::level::level_enum, std::string_view)>;
+
+    explicit callback_sink(callback_t callback) : callback(std::move(callback)) {}
+
+protected:
+    void sink_it_(const spdlog::details::log_msg& msg) override {
+        spdlog::memory_buf_t formatted;
+        this->formatter_->format(msg, formatted);
+        auto line = std::string_view(formatted.data(), formatted.size());
+        while (!line.empty() && (line.back() == '\n' || line.back() == '\r')) {
+            line.remove_suffix(1);
+        }
+        callback(msg.level, line);
+    }
+
+    void flush_() override {}
+
+private:
+    callback_t callback;
+};
+
+using callback_sink_mt = callback_sink<std::mutex>;
+using callback_sink_st = callback_sink<spdlog::details::null_mutex>;
+
+
+}  // namespace
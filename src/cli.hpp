@@ -4,6 +4,7 @@
 
 #include <CLI/CLI.hpp>
 #include <tuple>
+#include "config.hpp"
 #include "constants.hpp"
 #include "utils.hpp"
 
@@ -11,46 +12,46 @@
 namespace hy {
 
 
-constexpr auto DEFAULT_MAX_INTERCEPTION_DEVICES = 20;
-constexpr auto DEFAULT_KEYBOARD_SYMLINKS        = 1000;
-constexpr auto DEFAULT_POINTER_SYMLINKS         = 1000;
+struct AppInstallServiceConfig {
+    AppMainConfig main_cfg;
+    bool verbose;
+};
 
 
-struct AppMainConfig {
+struct AppUninstallServiceConfig {
+    AppMainConfig main_cfg;
     bool verbose;
-    bool lockdown;
-    int n_max_interception_devices;
-    int n_keyboard_symlinks;
-    int n_pointer_symlinks;
 };
 
 
-struct AppInstallServiceConfig {
+struct AppVerifyConfig {
     AppMainConfig main_cfg;
     bool verbose;
 };
 
 
-struct AppUninstallServiceConfig {
+struct AppFootprintConfig {
     AppMainConfig main_cfg;
     bool verbose;
+    int n_baseline_entries;  // 0: Read the current \Device directory.
+    double probe_ns;
 };
 
 
 inline auto parse_cli(int argc, wchar_t** argv) {
-    AppMainConfig             main_cfg              = {};
+    AppMainConfig             main_cfg              = default_main_config();
     AppInstallServiceConfig   install_service_cfg   = {};
     AppUninstallServiceConfig uninstall_service_cfg = {};
+    AppVerifyConfig           verify_cfg            = {};
+    AppFootprintConfig        footprint_cfg         = {};
     auto app = std::make_unique<CLI::App>();
     app->require_subcommand(-1);
     auto install_service_subcommand   = app->add_subcommand("install-service",   "");
     auto uninstall_service_subcommand = app->add_subcommand("uninstall-service", "");
+    auto verify_subcommand            = app->add_subcommand("verify",            "Check that the fix is in place, without changing anything. Prints a JSON report.");
+    auto footprint_subcommand         = app->add_subcommand("footprint",         "Estimate what the configured symlinks add to \\Device lookups. Prints a JSON report.");
     app->set_help_all_flag("--help-all", "Show help for all subcommands.");
 
-    main_cfg.n_max_interception_devices = DEFAULT_MAX_INTERCEPTION_DEVICES;
-    main_cfg.n_keyboard_symlinks        = DEFAULT_KEYBOARD_SYMLINKS;
-    main_cfg.n_pointer_symlinks         = DEFAULT_POINTER_SYMLINKS;
-
     app->add_flag("-v, --verbose",                main_cfg.verbose,                    "");
     app->add_flag("--lockdown",                   main_cfg.lockdown,                   "Restrict \\Device\\Interception* access to SYSTEM and Administrators only");
     app->add_option("--max-interception-devices", main_cfg.n_max_interception_devices, "")->capture_default_str();
@@ -61,6 +62,13 @@ inline auto parse_cli(int argc, wchar_t** argv) {
 
     uninstall_service_subcommand->add_flag("-v, --verbose", uninstall_service_cfg.verbose, "");
 
+    verify_subcommand->add_flag("-v, --verbose", verify_cfg.verbose, "");
+
+    footprint_cfg.probe_ns = DEFAULT_PROBE_NS;
+    footprint_subcommand->add_flag("-v, --verbose",       footprint_cfg.verbose,            "");
+    footprint_subcommand->add_option("--baseline-entries", footprint_cfg.n_baseline_entries, "Assume this many other \\Device entries instead of reading them")->capture_default_str();
+    footprint_subcommand->add_option("--probe-ns",         footprint_cfg.probe_ns,           "Cost of walking past one hash chain entry")->capture_default_str();
+
     auto cfg_file_path = (std::filesystem::path(get_program_data_folder()) / MY_DATA_DIR_NAME / MY_CFG_INI_NAME).lexically_normal();
     app->config_formatter(std::make_shared<CLI::ConfigINI>());
     app->set_config("--config", cfg_file_path.string(), "", false);
@@ -77,8 +85,10 @@ inline auto parse_cli(int argc, wchar_t** argv) {
 
     install_service_cfg.main_cfg   = main_cfg;
     uninstall_service_cfg.main_cfg = main_cfg;
+    verify_cfg.main_cfg            = main_cfg;
+    footprint_cfg.main_cfg         = main_cfg;
 
-    return std::tuple(std::move(app), main_cfg, install_service_cfg, uninstall_service_cfg);
+    return std::tuple(std::move(app), main_cfg, install_service_cfg, uninstall_service_cfg, verify_cfg, footprint_cfg);
 }
 
 
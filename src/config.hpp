@@ -0,0 +1,35 @@
+// Copyright (c) 2025 Hygor Ostrowskij de Morais <hygor.o.morais@gmail.com>
+
+#pragma once
+
+
+namespace hy {
+
+
+constexpr auto DEFAULT_MAX_INTERCEPTION_DEVICES = 20;
+constexpr auto DEFAULT_KEYBOARD_SYMLINKS        = 1000;
+constexpr auto DEFAULT_POINTER_SYMLINKS         = 1000;
+
+// footprint: nanoseconds per chain entry walked. A hash compare plus a cache miss on the next entry, roughly.
+constexpr double DEFAULT_PROBE_NS = 5.0;
+
+
+struct AppMainConfig {
+    bool verbose;
+    bool lockdown;
+    int n_max_interception_devices;
+    int n_keyboard_symlinks;
+    int n_pointer_symlinks;
+};
+
+
+inline AppMainConfig default_main_config() {
+    AppMainConfig cfg = {};
+    cfg.n_max_interception_devices = DEFAULT_MAX_INTERCEPTION_DEVICES;
+    cfg.n_keyboard_symlinks        = DEFAULT_KEYBOARD_SYMLINKS;
+    cfg.n_pointer_symlinks         = DEFAULT_POINTER_SYMLINKS;
+    return cfg;
+}
+
+
+}  // namespace
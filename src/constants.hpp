@@ -13,6 +13,9 @@ constexpr auto MY_SERVICE_DISPLAY_NAME = "Interception Driver Fix";
 constexpr auto MY_SERVICE_DESCRIPTION  = "Fixes reenumeration issues for the Interception Driver.";
 constexpr auto MY_DATA_DIR_NAME        = "Interception Driver Fix";
 constexpr auto MY_CFG_INI_NAME         = "interception-driver-fix.ini";
+constexpr auto MY_REGISTRY_KEY_NAME    = "SOFTWARE\\Interception Driver Fix";
+constexpr auto MY_STATUS_KEY_NAME      = "Status";  // Volatile, its class holds the status section name for the current boot.
+constexpr auto MY_STATUS_SHM_NAME      = "/interception-driver-fix.status";  // POSIX only
 
 
 }  // namespace
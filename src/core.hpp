@@ -2,182 +2,111 @@
 
 #pragma once
 
-#include <hy_windows.h>
-#include <ntstatus.h>
-#include <phnt.h>
-#include <tlhelp32.h>
-#include <sddl.h>
+#include <chrono>
+#include <functional>
+#include <string>
 #include <spdlog/spdlog.h>
-#include "cli.hpp"
+#include "backend.hpp"
+#include "config.hpp"
+#include "instrumentation.hpp"
+#include "plan.hpp"
+#include "status_block.hpp"
+#ifdef _WIN32
+#include "nt_backend.hpp"
+#endif
 
 
 namespace hy {
 
 
-inline void create_symlink(std::string link, std::string target) {
-    spdlog::debug("Symlinking {} to {}", link, target);
-
-    NTSTATUS ret;
-
-    auto link_name_buffer   = widen(link);
-    auto target_name_buffer = widen(target);
-    UNICODE_STRING link_name;
-    UNICODE_STRING target_name;
-    RtlInitUnicodeString(&link_name,   link_name_buffer.data());
-    RtlInitUnicodeString(&target_name, target_name_buffer.data());
-
-    OBJECT_ATTRIBUTES link_obj_attrs;
-
-    InitializeObjectAttributes(
-        &link_obj_attrs,
-        &link_name,
-        OBJ_PERMANENT,
-        nullptr,
-        nullptr
-    );
-
-    HANDLE link_handle;
-    ret = NtCreateSymbolicLinkObject(
-        &link_handle,
-        SYMBOLIC_LINK_ALL_ACCESS,
-        &link_obj_attrs,
-        &target_name
-    );
-
-    // Expected errors for NtCreateSymbolicLinkObject
-    // STATUS_OBJECT_NAME_COLLISION  // A symlink object with the same link name already exists.
-    // STATUS_OBJECT_TYPE_MISMATCH   // A non-symlink object with the same link name already exists.
-
-    if (ret != STATUS_SUCCESS
-        && ret != STATUS_OBJECT_NAME_COLLISION
-        && ret != STATUS_OBJECT_TYPE_MISMATCH
-    ) {
-        throw std::runtime_error(fmt::format("NtCreateSymbolicLinkObject error (0x{:x}).", static_cast<ULONG>(ret)));
-    }
-
-    NtClose(link_handle);
-}
-
-
-inline void remove_symlink(std::string link) {
-    spdlog::debug("Removing symlink {}", link);
-
-    NTSTATUS ret;
+constexpr auto STANDARD_INTERCEPTION_SDDL = "D:(A;;FRFW;;;WD)(A;;FR;;;RC)(A;;FA;;;SY)(A;;FA;;;BA)";
+constexpr auto LOCKDOWN_INTERCEPTION_SDDL = "D:(A;;FA;;;SY)(A;;FA;;;BA)";
 
-    auto link_name_buffer = widen(link);
-    UNICODE_STRING link_name;
-    RtlInitUnicodeString(&link_name, link_name_buffer.data());
 
-    OBJECT_ATTRIBUTES link_obj_attrs;
+inline const char* interception_sddl(bool lockdown) {
+    return lockdown ? LOCKDOWN_INTERCEPTION_SDDL : STANDARD_INTERCEPTION_SDDL;
+}
 
-    InitializeObjectAttributes(
-        &link_obj_attrs,
-        &link_name,
-        0,
-        nullptr,
-        nullptr
-    );
 
-    HANDLE link_handle;
-    ret = NtOpenSymbolicLinkObject(
-        &link_handle,
-        DELETE,
-        &link_obj_attrs
-    );
-    if (ret == STATUS_OBJECT_NAME_NOT_FOUND  // No symlink to delete
-        || ret == STATUS_OBJECT_TYPE_MISMATCH  // Not a symlink
-    ) {
-        return;
-    }
-    if (ret < 0) {
-        throw std::runtime_error(fmt::format("NtOpenSymbolicLinkObject error (0x{:x}).", static_cast<ULONG>(ret)));
-    }
+struct ApplyResult {
+    int n_devices;
+    int n_symlinks_created;
+    int n_symlinks_existing;
+    int n_symlinks_name_taken;
+    std::chrono::nanoseconds duration;
+    ResourceSnapshot resources;  // Used by this apply.
+};
 
-    ret = NtMakeTemporaryObject(link_handle);
-    if (ret < 0) {
-        throw std::runtime_error(fmt::format("NtMakeTemporaryObject error (0x{:x}).", static_cast<ULONG>(ret)));
-    }
 
-    NtClose(link_handle);
-}
+// Called after every plan batch with the number of operations done so far and the plan size.
+using ApplyProgressFn = std::function<void(size_t done, size_t total)>;
 
 
-inline void set_interception_device_permissions(int idx, bool lockdown) {
-    NTSTATUS ret;
+inline ApplyResult apply(const AppMainConfig& cfg, NamespaceBackend& backend, spdlog::logger& logger, const ApplyProgressFn& progress = nullptr) {
+    PhaseScope phase("apply", &logger);
+    ApplyResult result = {};
 
-    constexpr auto standard_sddl = "D:(A;;FRFW;;;WD)(A;;FR;;;RC)(A;;FA;;;SY)(A;;FA;;;BA)";
-    constexpr auto lockdown_sddl = "D:(A;;FA;;;SY)(A;;FA;;;BA)";
+    logger.info("Lockdown mode: {}", cfg.lockdown ? "enabled" : "disabled");
+    std::string sddl = interception_sddl(cfg.lockdown);
 
-    auto sddl = lockdown ? lockdown_sddl : standard_sddl;
+    SymlinkPlan plan(cfg);
+    for (auto batch : plan.batches()) {
+        for (auto& entry : batch) {
+            if (entry.op.kind == PlanOpKind::set_device_permissions) {
+                backend.set_interception_device_permissions(entry.op.idx, sddl);
+                logger.debug("Setting {} SDDL to {}", entry.name, sddl);
+                result.n_devices++;
+                continue;
+            }
 
-    PSECURITY_DESCRIPTOR psd;
-    if (!ConvertStringSecurityDescriptorToSecurityDescriptorW(
-        widen(sddl).data(),
-        SDDL_REVISION_1,
-        &psd,
-        nullptr
-    )) {
-        throw std::runtime_error("ConvertStringSecurityDescriptorToSecurityDescriptorW error.");
-    }
+            logger.debug("Symlinking {} to {}", entry.name, entry.target);
+            switch (backend.create_symlink(entry.name, entry.target)) {
+                case SymlinkStatus::created:        result.n_symlinks_created++;    break;
+                case SymlinkStatus::already_exists: result.n_symlinks_existing++;   break;
+                case SymlinkStatus::name_taken:     result.n_symlinks_name_taken++; break;
+            }
+        }
 
-    auto device_path_str = fmt::format("\\Device\\Interception{:02}", idx);
-    auto device_path_buffer = widen(device_path_str);
-    UNICODE_STRING device_path;
-    RtlInitUnicodeString(&device_path, device_path_buffer.data());
-    HANDLE hDevice = nullptr;
-    IO_STATUS_BLOCK iosb;
-    OBJECT_ATTRIBUTES oa;
-    InitializeObjectAttributes(&oa, &device_path, OBJ_CASE_INSENSITIVE, nullptr, nullptr);
-
-    ret = NtOpenFile(
-        &hDevice,
-        READ_CONTROL | WRITE_DAC | WRITE_OWNER,
-        &oa,
-        &iosb,
-        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
-        0
-    );
-    if (ret < 0) {
-        throw std::runtime_error("NtOpenFile error.");
+        if (progress) {
+            progress(batch.back().index + 1, plan.size());
+        }
     }
 
-    ret = NtSetSecurityObject(hDevice, DACL_SECURITY_INFORMATION, psd);
-    if (ret < 0) {
-        throw std::runtime_error("NtSetSecurityObject error.");
-    }
+    auto& record = phase.finish();
+    result.duration  = record.duration;
+    result.resources = record.delta;
 
-    spdlog::debug("Setting {} SDDL to {}", device_path_str, sddl);
+    return result;
 }
 
 
-inline int real_main(AppMainConfig cfg) {
-    spdlog::info("Lockdown mode: {}", cfg.lockdown ? "enabled" : "disabled");
-    for (int i = 0; i < cfg.n_max_interception_devices; i++) {
-        set_interception_device_permissions(i, cfg.lockdown);
-    }
-
-    for (int i = 10; i < cfg.n_keyboard_symlinks; i += 10) {
-        for (int j = 0; j < 10; j++) {
-            auto link   = fmt::format("\\Device\\KeyboardClass{}", i+j);
-            auto target = fmt::format("\\Device\\KeyboardClass{}", j);
-
-            create_symlink(link, target);
+inline int real_main(const AppMainConfig& cfg, NamespaceBackend& backend, spdlog::logger& logger, StatusBlockWriter* status = nullptr, const ApplyProgressFn& progress = nullptr) {
+    ApplyResult result;
+    try {
+        result = apply(cfg, backend, logger, progress);
+    } catch (...) {
+        if (status) {
+            status->record_error();
         }
+        throw;
     }
 
-    for (int i = 10; i < cfg.n_pointer_symlinks; i += 10) {
-        for (int j = 0; j < 10; j++) {
-            auto link   = fmt::format("\\Device\\PointerClass{}", i+j);
-            auto target = fmt::format("\\Device\\PointerClass{}", j);
-
-            create_symlink(link, target);
-        }
+    if (status) {
+        status->record_apply(cfg, result.n_symlinks_created, result.n_symlinks_existing, result.n_symlinks_name_taken, result.duration);
     }
 
-    spdlog::info("Success");
+    logger.info("Success");
 
     return 0;
 }
 
 
+#ifdef _WIN32
+inline int real_main(const AppMainConfig& cfg, StatusBlockWriter* status = nullptr) {
+    NtNamespaceBackend backend;
+    return real_main(cfg, backend, *spdlog::default_logger(), status);
+}
+#endif
+
+
 }  // namespace
@@ -0,0 +1,159 @@
+// Copyright (c) 2025 Hygor Ostrowskij de Morais <hygor.o.morais@gmail.com>
+
+#pragma once
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include "backend.hpp"
+
+
+namespace hy {
+
+
+// NTSTATUS values worth injecting. Named apart from the ntstatus.h macros so this builds on any platform.
+namespace ntstatus {
+    constexpr uint32_t access_denied          = 0xC0000022;
+    constexpr uint32_t object_name_not_found  = 0xC0000034;
+    constexpr uint32_t insufficient_resources = 0xC000009A;
+    constexpr uint32_t privilege_not_held     = 0xC0000061;
+    constexpr uint32_t io_timeout             = 0xC00000B5;
+
+    // Accepted by name wherever a status to inject is given on the command line.
+    constexpr std::pair<std::string_view, uint32_t> named[] = {
+        { "access_denied",          access_denied },
+        { "object_name_not_found",  object_name_not_found },
+        { "insufficient_resources", insufficient_resources },
+        { "privilege_not_held",     privilege_not_held },
+        { "io_timeout",             io_timeout },
+    };
+}
+
+
+struct LatencyDistribution {
+    enum class Kind {
+        none,
+        fixed,      // Always a.
+        uniform,    // Between a and b.
+        lognormal,  // Median a, shape sigma. Long right tail, like a contended object manager lock.
+    };
+
+    Kind kind = Kind::none;
+    std::chrono::nanoseconds a = {};
+    std::chrono::nanoseconds b = {};
+    double sigma = 1.0;
+
+    template<typename Rng>
+    std::chrono::nanoseconds sample(Rng& rng) const {
+        switch (kind) {
+            case Kind::none:
+                return {};
+            case Kind::fixed:
+                return a;
+            case Kind::uniform:
+                return std::chrono::nanoseconds(std::uniform_int_distribution<int64_t>(a.count(), std::max(a, b).count())(rng));
+            case Kind::lognormal:
+                return std::chrono::nanoseconds(static_cast<int64_t>(
+                    std::lognormal_distribution<double>(std::log(static_cast<double>(std::max<int64_t>(a.count(), 1))), sigma)(rng)));
+        }
+        return {};
+    }
+};
+
+
+struct FaultConfig {
+    double error_rate = 0.0;  // Probability of any mutating call failing.
+    uint32_t random_error_status = ntstatus::insufficient_resources;
+    // Mutating call index -> status it fails with. During apply the call index is the plan index.
+    std::map<size_t, uint32_t> fail_at;
+    LatencyDistribution latency;  // Added to every call, queries included.
+    uint64_t seed = 0;
+};
+
+
+// Wraps another backend and makes its mutating calls fail or stall on demand.
+//   Failures happen before the wrapped call, so a failed operation leaves no trace in the wrapped backend.
+class FaultInjectingBackend : public NamespaceBackend {
+public:
+    FaultInjectingBackend(NamespaceBackend& inner, FaultConfig cfg) : inner(inner), cfg(std::move(cfg)), rng(this->cfg.seed) {}
+
+    SymlinkStatus create_symlink(const std::string& link, const std::string& target) override {
+        before_mutation("NtCreateSymbolicLinkObject");
+        return inner.create_symlink(link, target);
+    }
+
+    void remove_symlink(const std::string& link) override {
+        before_mutation("NtMakeTemporaryObject");
+        inner.remove_symlink(link);
+    }
+
+    void set_interception_device_permissions(int idx, const std::string& sddl) override {
+        before_mutation("NtSetSecurityObject");
+        inner.set_interception_device_permissions(idx, sddl);
+    }
+
+    std::vector<DirectoryEntry> list_directory(const std::string& path) override {
+        stall();
+        return inner.list_directory(path);
+    }
+
+    std::optional<std::string> query_symlink(const std::string& link) override {
+        stall();
+        return inner.query_symlink(link);
+    }
+
+    std::optional<std::string> query_interception_device_sddl(int idx) override {
+        stall();
+        return inner.query_interception_device_sddl(idx);
+    }
+
+    std::string normalize_sddl(const std::string& sddl) override {
+        return inner.normalize_sddl(sddl);
+    }
+
+    size_t mutation_count() const { return n_mutations; }
+    size_t injected_error_count() const { return n_injected_errors; }
+
+private:
+    void stall() {
+        auto delay = cfg.latency.sample(rng);
+        if (delay <= std::chrono::nanoseconds::zero()) {
+            return;
+        }
+        // Sleep granularity is about a millisecond on Windows, so shorter delays are spun.
+        if (delay >= std::chrono::milliseconds(1)) {
+            std::this_thread::sleep_for(delay);
+            return;
+        }
+        auto until = std::chrono::steady_clock::now() + delay;
+        while (std::chrono::steady_clock::now() < until) {}
+    }
+
+    void before_mutation(const char* function) {
+        auto idx = n_mutations++;
+        stall();
+
+        if (auto it = cfg.fail_at.find(idx); it != cfg.fail_at.end()) {
+            n_injected_errors++;
+            throw nt_status_error(function, static_cast<int32_t>(it->second));
+        }
+        if (cfg.error_rate > 0.0 && std::uniform_real_distribution<double>(0.0, 1.0)(rng) < cfg.error_rate) {
+            n_injected_errors++;
+            throw nt_status_error(function, static_cast<int32_t>(cfg.random_error_status));
+        }
+    }
+
+    NamespaceBackend& inner;
+    FaultConfig cfg;
+    std::mt19937_64 rng;
+    size_t n_mutations = 0;
+    size_t n_injected_errors = 0;
+};
+
+
+}  // namespace
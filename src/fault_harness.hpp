@@ -0,0 +1,129 @@
+// Copyright (c) 2025 Hygor Ostrowskij de Morais <hygor.o.morais@gmail.com>
+
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+#include "bench_utils.hpp"
+#include "config.hpp"
+#include "core.hpp"
+#include "fault_backend.hpp"
+#include "sim_backend.hpp"
+#include "verify.hpp"
+
+
+namespace hy {
+
+
+struct FaultHarnessConfig {
+    AppMainConfig main_cfg;
+    FaultConfig faults;
+    int n_runs = 100;
+};
+
+
+struct FaultHarnessReport {
+    int n_runs;
+    int n_failed;
+    DurationSummary durations;
+    std::map<uint32_t, int> failures_by_status;  // 0 for errors without an NTSTATUS.
+    std::map<std::string, int> unapplied_devices;  // \Device\InterceptionNN -> runs where its DACL wasn't set.
+    std::map<std::string, int> unapplied_links;    // Symlink name -> runs where it wasn't created.
+};
+
+
+// Runs real_main's apply step n_runs times against a fresh simulated namespace wrapped in a FaultInjectingBackend,
+//   then checks with verify what each run left undone.
+inline FaultHarnessReport run_fault_harness(const FaultHarnessConfig& cfg) {
+    FaultHarnessReport report = {};
+    report.n_runs = cfg.n_runs;
+
+    auto logger = make_null_logger("fault-harness");
+
+    std::vector<std::chrono::nanoseconds> durations;
+    durations.reserve(cfg.n_runs);
+
+    for (int run = 0; run < cfg.n_runs; run++) {
+        SimNamespace ns;
+        ns.add_default_devices(cfg.main_cfg.n_max_interception_devices);
+        SimNamespaceBackend sim(ns);
+
+        auto faults = cfg.faults;
+        faults.seed = cfg.faults.seed + run;
+        FaultInjectingBackend backend(sim, std::move(faults));
+
+        auto start = std::chrono::steady_clock::now();
+        try {
+            apply(cfg.main_cfg, backend, *logger);
+        } catch (const NtStatusError& e) {
+            report.n_failed++;
+            report.failures_by_status[e.status()]++;
+        } catch (const std::exception&) {
+            report.n_failed++;
+            report.failures_by_status[0]++;
+        }
+        durations.push_back(std::chrono::steady_clock::now() - start);
+
+        for (auto& issue : verify(cfg.main_cfg, sim).issues) {
+            switch (issue.kind) {
+                case VerifyIssueKind::dacl_drift:
+                case VerifyIssueKind::missing_device:
+                    report.unapplied_devices[issue.name]++;
+                    break;
+                default:
+                    report.unapplied_links[issue.name]++;
+                    break;
+            }
+        }
+    }
+
+    report.durations = summarize_durations(durations);
+
+    return report;
+}
+
+
+// Single line JSON, in the same spirit as format_verify_report. At most max_listed links are named.
+inline std::string format_fault_harness_report(const FaultHarnessReport& report, size_t max_listed = 100) {
+    std::string out;
+    fmt::format_to(std::back_inserter(out), R"({{"runs":{},"failed":{},{},"failures":{{)",
+        report.n_runs, report.n_failed, format_duration_summary(report.durations));
+
+    bool first = true;
+    for (auto& [status, count] : report.failures_by_status) {
+        fmt::format_to(std::back_inserter(out), R"({}"0x{:08x}":{})", first ? "" : ",", status, count);
+        first = false;
+    }
+
+    out += R"(},"unapplied_devices":{)";
+    first = true;
+    for (auto& [name, count] : report.unapplied_devices) {
+        out += first ? "" : ",";
+        first = false;
+        append_json_string(out, name);
+        fmt::format_to(std::back_inserter(out), ":{}", count);
+    }
+
+    fmt::format_to(std::back_inserter(out), R"(}},"unapplied_link_count":{},"unapplied_links":{{)", report.unapplied_links.size());
+    first = true;
+    size_t n_listed = 0;
+    for (auto& [name, count] : report.unapplied_links) {
+        if (n_listed++ == max_listed) {
+            break;
+        }
+        out += first ? "" : ",";
+        first = false;
+        append_json_string(out, name);
+        fmt::format_to(std::back_inserter(out), ":{}", count);
+    }
+
+    out += "}}";
+    return out;
+}
+
+
+}  // namespace
@@ -0,0 +1,133 @@
+// Copyright (c) 2025 Hygor Ostrowskij de Morais <hygor.o.morais@gmail.com>
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <fmt/format.h>
+#include "config.hpp"
+#include "object_directory_model.hpp"
+#include "plan.hpp"
+
+
+namespace hy {
+
+
+struct FootprintReport {
+    size_t n_baseline_entries;
+    size_t n_added_entries;
+    size_t min_added_per_bucket;
+    size_t max_added_per_bucket;
+    double baseline_hit_probes;  // Mean chain entries walked to find an existing \Device entry, before the fix.
+    double hit_probes;           // The same, after the fix.
+    double baseline_miss_probes; // Mean chain length for a name that doesn't exist, before the fix.
+    double miss_probes;          // The same, after the fix.
+    double added_lookup_ns;      // Extra time per \Device lookup, averaged over hits and misses.
+    size_t class_device_probes_max;  // Worst case chain entries walked to find \Device\KeyboardClass0-9/PointerClass0-9 after the fix.
+    size_t keyboard_reconnect_headroom;  // Extra KeyboardClassN indices covered.
+    size_t pointer_reconnect_headroom;
+};
+
+
+// Estimates what the symlinks real_main would create for cfg add to \Device lookups.
+//   baseline holds the names already in \Device, relative to it. The new links are inserted after them.
+inline FootprintReport estimate_footprint(const AppMainConfig& cfg, const std::vector<std::string>& baseline, double probe_ns = DEFAULT_PROBE_NS) {
+    FootprintReport report = {};
+    SymlinkPlan plan(cfg);
+
+    ObjectDirectoryModel dir;
+    for (auto& name : baseline) {
+        dir.insert(name);
+    }
+    std::array<size_t, OBJECT_DIRECTORY_BUCKETS> baseline_chains;
+    for (size_t b = 0; b < OBJECT_DIRECTORY_BUCKETS; b++) {
+        baseline_chains[b] = dir.chain_length(b);
+    }
+
+    auto mean_hit_probes = [&] {
+        if (baseline.empty()) {
+            return 0.0;
+        }
+        double total = 0.0;
+        for (auto& name : baseline) {
+            total += dir.lookup_probes(name);
+        }
+        return total / baseline.size();
+    };
+
+    report.n_baseline_entries   = baseline.size();
+    report.baseline_hit_probes  = mean_hit_probes();
+    report.baseline_miss_probes = static_cast<double>(dir.size()) / OBJECT_DIRECTORY_BUCKETS;
+
+    std::string name;
+    for (auto batch : plan.batches()) {
+        for (auto& entry : batch) {
+            if (entry.op.kind != PlanOpKind::create_symlink) {
+                continue;
+            }
+            name = std::string_view(entry.name).substr(std::string_view("\\Device\\").size());
+            if (!dir.contains(name)) {
+                dir.insert(name);
+                report.n_added_entries++;
+            }
+        }
+    }
+
+    report.min_added_per_bucket = SIZE_MAX;
+    for (size_t b = 0; b < OBJECT_DIRECTORY_BUCKETS; b++) {
+        auto added = dir.chain_length(b) - baseline_chains[b];
+        report.min_added_per_bucket = std::min(report.min_added_per_bucket, added);
+        report.max_added_per_bucket = std::max(report.max_added_per_bucket, added);
+    }
+
+    report.hit_probes  = mean_hit_probes();
+    report.miss_probes = static_cast<double>(dir.size()) / OBJECT_DIRECTORY_BUCKETS;
+    report.added_lookup_ns = probe_ns * ((report.hit_probes - report.baseline_hit_probes) + (report.miss_probes - report.baseline_miss_probes)) / 2.0;
+
+    for (int i = 0; i < 10; i++) {
+        report.class_device_probes_max = std::max({
+            report.class_device_probes_max,
+            dir.lookup_probes(fmt::format("KeyboardClass{}", i)),
+            dir.lookup_probes(fmt::format("PointerClass{}", i)),
+        });
+    }
+
+    report.keyboard_reconnect_headroom = plan.keyboard_link_count();
+    report.pointer_reconnect_headroom  = plan.pointer_link_count();
+
+    return report;
+}
+
+
+// Stand-in for a \Device directory with n entries, for when the real one can't be read.
+//   Most of \Device is unnamed PDOs (00000034), plus the class devices the links point at.
+inline std::vector<std::string> synthetic_device_baseline(size_t n) {
+    std::vector<std::string> names;
+    names.reserve(n);
+    for (int i = 0; i < 10 && names.size() < n; i++) {
+        names.push_back(fmt::format("KeyboardClass{}", i));
+        names.push_back(fmt::format("PointerClass{}", i));
+    }
+    for (size_t i = 0; names.size() < n; i++) {
+        names.push_back(fmt::format("{:08x}", i));
+    }
+    names.resize(n);
+    return names;
+}
+
+
+inline std::string format_footprint_report(const FootprintReport& r) {
+    return fmt::format(
+        R"({{"baseline_entries":{},"added_entries":{},"added_per_bucket":{{"min":{},"max":{}}},)"
+        R"("hit_probes":{{"before":{:.1f},"after":{:.1f}}},"miss_probes":{{"before":{:.1f},"after":{:.1f}}},)"
+        R"("added_lookup_ns":{:.1f},"class_device_probes_max":{},"reconnect_headroom":{{"keyboard":{},"pointer":{}}}}})",
+        r.n_baseline_entries, r.n_added_entries, r.min_added_per_bucket, r.max_added_per_bucket,
+        r.baseline_hit_probes, r.hit_probes, r.baseline_miss_probes, r.miss_probes,
+        r.added_lookup_ns, r.class_device_probes_max, r.keyboard_reconnect_headroom, r.pointer_reconnect_headroom);
+}
+
+
+}  // namespace
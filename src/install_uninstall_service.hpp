@@ -3,12 +3,20 @@
 #pragma once
 
 #include <hy_windows.h>
+#include <chrono>
+#include <cstddef>
 #include <filesystem>
+#include <optional>
+#include <string_view>
+#include <vector>
+#include <fmt/format.h>
 #include <spdlog/spdlog.h>
-#include <sr/scope.h>
+#include "config.hpp"
 #include "constants.hpp"
+#include "instrumentation.hpp"
+#include "service_manager.hpp"
+#include "status_block.hpp"
 #include "utils.hpp"
-#include "mutex_utils.hpp"
 
 
 namespace hy {
@@ -32,145 +40,257 @@ inline std::wstring get_current_executable() {
 }
 
 
-inline void uninstall_service() {
-    spdlog::info("Uninstalling service.");
-
-    auto hSCM = sr::make_unique_resource_checked(
-        OpenSCManagerW(
-            nullptr,
-            nullptr,
-            DELETE
-        ),
-        nullptr,
-        CloseServiceHandle
-    );
-    if (!hSCM.get()) {
-        throw std::runtime_error("OpenSCManagerW error (uninstall).");
+// Service handles are only opened when first needed, so constructing this is cheap.
+class WinServiceManager : public ServiceManager {
+public:
+    explicit WinServiceManager(DWORD scm_access) {
+        scm = OpenSCManagerW(nullptr, nullptr, scm_access);
+        if (!scm) {
+            throw std::runtime_error(fmt::format("OpenSCManagerW error ({}).", GetLastError()));
+        }
+        track_handle_opened();
     }
 
-    auto hService = sr::make_unique_resource_checked(
-        OpenServiceW(
-            hSCM.get(),
-            widen(MY_SERVICE_NAME).data(),
-            SC_MANAGER_ALL_ACCESS
-        ),
-        nullptr,
-        CloseServiceHandle
-    );
-    if (!hService.get()) {
-        if (GetLastError() == ERROR_SERVICE_DOES_NOT_EXIST) {
-            return;  // The service has already been uninstalled.
+    WinServiceManager(const WinServiceManager&) = delete;
+    WinServiceManager& operator=(const WinServiceManager&) = delete;
+
+    ~WinServiceManager() override {
+        if (service) {
+            CloseServiceHandle(service);
+            track_handle_closed();
         }
-        throw std::runtime_error("OpenServiceW error.");
+        CloseServiceHandle(scm);
+        track_handle_closed();
     }
 
-    SERVICE_STATUS serviceStatus = {};
-    if(!ControlService(
-        hService.get(),
-        SERVICE_CONTROL_STOP,
-        &serviceStatus
-    )) {
-        if (GetLastError() != ERROR_SERVICE_NOT_ACTIVE) {
-            throw std::runtime_error("ControlService error.");
+    std::optional<ServiceConfig> query_config() override {
+        if (!open()) {
+            return std::nullopt;
         }
-    }
 
-    if(!DeleteService(hService.get())) {
-        throw std::runtime_error("DeleteService error.");
-    }
+        auto buffer = query_buffer("QueryServiceConfigW", [&](std::byte* data, DWORD size, DWORD* needed) {
+            return QueryServiceConfigW(service, reinterpret_cast<LPQUERY_SERVICE_CONFIGW>(data), size, needed);
+        });
+        auto config = reinterpret_cast<LPQUERY_SERVICE_CONFIGW>(buffer.data());
 
-    spdlog::info("Uninstalled service successfully.");
-}
+        ServiceConfig cfg = {};
+        cfg.service_type  = config->dwServiceType;
+        cfg.start_type    = config->dwStartType;
+        cfg.error_control = config->dwErrorControl;
+        cfg.binary_path   = config->lpBinaryPathName ? narrow(config->lpBinaryPathName) : "";
+        cfg.display_name  = config->lpDisplayName ? narrow(config->lpDisplayName) : "";
 
+        buffer = query_config2(SERVICE_CONFIG_DESCRIPTION);
+        if (auto description = reinterpret_cast<LPSERVICE_DESCRIPTIONW>(buffer.data())->lpDescription) {
+            cfg.description = narrow(description);
+        }
 
-inline void install_service() {
-    spdlog::info("Installing service.");
+        buffer = query_config2(SERVICE_CONFIG_REQUIRED_PRIVILEGES_INFO);
+        if (auto privilege = reinterpret_cast<LPSERVICE_REQUIRED_PRIVILEGES_INFOW>(buffer.data())->pmszRequiredPrivileges) {
+            for (; *privilege; privilege += wcslen(privilege) + 1) {
+                cfg.required_privileges.push_back(narrow(privilege));
+            }
+        }
 
-    auto hSCM = sr::make_unique_resource_checked(
-        OpenSCManagerW(
-            nullptr,
-            nullptr,
-            SC_MANAGER_CREATE_SERVICE
-        ),
-        nullptr,
-        CloseServiceHandle
-    );
-    if (!hSCM.get()) {
-        throw std::runtime_error("OpenSCManagerW error (install).");
+        return cfg;
     }
 
-    auto hService = sr::make_unique_resource_checked(
-        CreateServiceW(
-            hSCM.get(),
+    std::optional<ServiceState> query_state() override {
+        if (!open()) {
+            return std::nullopt;
+        }
+
+        SERVICE_STATUS status = {};
+        if (!QueryServiceStatus(service, &status)) {
+            throw std::runtime_error(fmt::format("QueryServiceStatus error ({}).", GetLastError()));
+        }
+        return static_cast<ServiceState>(status.dwCurrentState);
+    }
+
+    void create(const ServiceConfig& cfg) override {
+        service = CreateServiceW(
+            scm,
             widen(MY_SERVICE_NAME).data(),
-            widen(MY_SERVICE_DISPLAY_NAME).data(),
-            SC_MANAGER_ALL_ACCESS,
-            SERVICE_WIN32_OWN_PROCESS,
-            SERVICE_AUTO_START,  // SERVICE_DEMAND_START,
-            SERVICE_ERROR_NORMAL,
-            get_current_executable().c_str(),  // dst.wstring().c_str(),
+            widen(cfg.display_name).data(),
+            SERVICE_ALL_ACCESS,
+            cfg.service_type,
+            cfg.start_type,
+            cfg.error_control,
+            widen(cfg.binary_path).data(),
             nullptr,
             nullptr,
             nullptr,
             nullptr,
             nullptr
-        ),
-        nullptr,
-        CloseServiceHandle
-    );
-    if (!hService.get()) {
-        if (GetLastError() == ERROR_SERVICE_EXISTS) {
-            hService = sr::make_unique_resource_checked(
-                OpenServiceW(
-                    hSCM.get(),
-                    widen(MY_SERVICE_NAME).data(),
-                    SC_MANAGER_ALL_ACCESS
-                ),
+        );
+        if (!service) {
+            throw std::runtime_error(fmt::format("CreateServiceW error ({}).", GetLastError()));
+        }
+        track_handle_opened();
+
+        ServiceConfigUpdate update;
+        update.description = cfg.description;
+        update.required_privileges = cfg.required_privileges;
+        change_config(update);
+    }
+
+    void change_config(const ServiceConfigUpdate& update) override {
+        if (!open()) {
+            throw std::runtime_error("Service not installed.");
+        }
+
+        if (update.has_base_fields()) {
+            auto binary_path  = update.binary_path  ? widen(*update.binary_path)  : std::wstring();
+            auto display_name = update.display_name ? widen(*update.display_name) : std::wstring();
+            if (!ChangeServiceConfigW(
+                service,
+                update.service_type.value_or(SERVICE_NO_CHANGE),
+                update.start_type.value_or(SERVICE_NO_CHANGE),
+                update.error_control.value_or(SERVICE_NO_CHANGE),
+                update.binary_path ? binary_path.c_str() : nullptr,
+                nullptr,
                 nullptr,
-                CloseServiceHandle
-            );
-            if (!hService.get()) {
-                throw std::runtime_error("OpenServiceW error.");
+                nullptr,
+                nullptr,
+                nullptr,
+                update.display_name ? display_name.c_str() : nullptr
+            )) {
+                throw std::runtime_error(fmt::format("ChangeServiceConfigW error ({}).", GetLastError()));
+            }
+        }
+
+        if (update.description) {
+            auto w_service_description = widen(*update.description);
+            SERVICE_DESCRIPTIONW serviceDescription = {};
+            serviceDescription.lpDescription = w_service_description.data();
+
+            if (!ChangeServiceConfig2W(
+                service,
+                SERVICE_CONFIG_DESCRIPTION,
+                &serviceDescription
+            )) {
+                throw std::runtime_error(fmt::format("ChangeServiceConfig2W error (description, {}).", GetLastError()));
+            }
+        }
+
+        if (update.required_privileges) {
+            std::wstring privileges;
+            for (auto& privilege : *update.required_privileges) {
+                privileges += widen(privilege);
+                privileges += L'\0';
+            }
+            privileges += L'\0';
+
+            SERVICE_REQUIRED_PRIVILEGES_INFOW servicePrivileges = {};
+            servicePrivileges.pmszRequiredPrivileges = privileges.data();
+
+            if (!ChangeServiceConfig2W(
+                service,
+                SERVICE_CONFIG_REQUIRED_PRIVILEGES_INFO,
+                &servicePrivileges
+            )) {
+                throw std::runtime_error(fmt::format("ChangeServiceConfig2W error (privileges, {}).", GetLastError()));
             }
-        } else {
-            throw std::runtime_error("CreateServiceW error.");
         }
     }
 
-    auto w_service_description = widen(MY_SERVICE_DESCRIPTION);
-    SERVICE_DESCRIPTIONW serviceDescription = {};
-    serviceDescription.lpDescription = w_service_description.data();
+    void start() override {
+        if (!open()) {
+            throw std::runtime_error("Service not installed.");
+        }
+        if (!StartServiceW(service, 0, nullptr)) {
+            if (GetLastError() != ERROR_SERVICE_ALREADY_RUNNING) {
+                throw std::runtime_error(fmt::format("StartServiceW error ({}).", GetLastError()));
+            }
+        }
+    }
 
-    if (!ChangeServiceConfig2W(
-        hService.get(),
-        SERVICE_CONFIG_DESCRIPTION,
-        &serviceDescription
-    )) {
-        throw std::runtime_error("ChangeServiceConfig2W error (description).");
+    void stop() override {
+        if (!open()) {
+            throw std::runtime_error("Service not installed.");
+        }
+        SERVICE_STATUS serviceStatus = {};
+        if (!ControlService(service, SERVICE_CONTROL_STOP, &serviceStatus)) {
+            if (GetLastError() != ERROR_SERVICE_NOT_ACTIVE) {
+                throw std::runtime_error(fmt::format("ControlService error ({}).", GetLastError()));
+            }
+        }
     }
 
-    SERVICE_REQUIRED_PRIVILEGES_INFOW servicePrivileges = {};
-    // This function fails open silently if any incorrectly named privileges are set, so beware.
-    //   It fails open as if no required privileges were requested, which ends up allowing all privileges.
-    servicePrivileges.pmszRequiredPrivileges = const_cast<LPWSTR>(L"SeCreatePermanentPrivilege\0");
-
-    if (!ChangeServiceConfig2W(
-        hService.get(),
-        SERVICE_CONFIG_REQUIRED_PRIVILEGES_INFO,
-        &servicePrivileges
-    )) {
-        throw std::runtime_error("ChangeServiceConfig2W error (privileges).");
+    void remove() override {
+        if (!open()) {
+            return;  // The service has already been uninstalled.
+        }
+        if (!DeleteService(service)) {
+            if (GetLastError() != ERROR_SERVICE_MARKED_FOR_DELETE) {
+                throw std::runtime_error(fmt::format("DeleteService error ({}).", GetLastError()));
+            }
+        }
     }
 
-    if (!StartServiceW(
-        hService.get(),
-        0,
-        nullptr
-    )) {
-        throw std::runtime_error("StartServiceW error.");
+    void wait(std::chrono::milliseconds duration) override {
+        Sleep(static_cast<DWORD>(duration.count()));
     }
 
-    spdlog::info("Installed service successfully.");
+private:
+    // Returns false if the service isn't installed.
+    bool open() {
+        if (service) {
+            return true;
+        }
+        service = OpenServiceW(scm, widen(MY_SERVICE_NAME).data(), SERVICE_ALL_ACCESS);
+        if (!service) {
+            if (GetLastError() == ERROR_SERVICE_DOES_NOT_EXIST) {
+                return false;
+            }
+            throw std::runtime_error(fmt::format("OpenServiceW error ({}).", GetLastError()));
+        }
+        track_handle_opened();
+        return true;
+    }
+
+    // Both config queries document 8 KB as their largest result, so the sizing round trip is only a fallback.
+    template<typename Query>
+    static std::vector<std::byte> query_buffer(std::string_view what, Query query) {
+        std::vector<std::byte> buffer(SERVICE_CONFIG_BUFFER_SIZE);
+        DWORD needed = 0;
+        if (!query(buffer.data(), static_cast<DWORD>(buffer.size()), &needed)) {
+            if (GetLastError() != ERROR_INSUFFICIENT_BUFFER) {
+                throw std::runtime_error(fmt::format("{} error ({}).", what, GetLastError()));
+            }
+            buffer.resize(needed);
+            if (!query(buffer.data(), needed, &needed)) {
+                throw std::runtime_error(fmt::format("{} error ({}).", what, GetLastError()));
+            }
+        }
+        return buffer;
+    }
+
+    std::vector<std::byte> query_config2(DWORD level) {
+        return query_buffer(fmt::format("QueryServiceConfig2W ({})", level), [&](std::byte* data, DWORD size, DWORD* needed) {
+            return QueryServiceConfig2W(service, level, reinterpret_cast<LPBYTE>(data), size, needed);
+        });
+    }
+
+    static constexpr DWORD SERVICE_CONFIG_BUFFER_SIZE = 8 * 1024;
+
+    SC_HANDLE scm = nullptr;
+    SC_HANDLE service = nullptr;
+};
+
+
+inline bool uninstall_service() {
+    WinServiceManager scm(SC_MANAGER_CONNECT);
+    return uninstall_service(scm, *spdlog::default_logger());
+}
+
+
+inline InstallResult install_service(const AppMainConfig& cfg) {
+    auto status = StatusBlockMapping::open_read_only();
+    bool apply_current = status && is_apply_current(*status->get(), cfg);
+
+    WinServiceManager scm(SC_MANAGER_CONNECT | SC_MANAGER_CREATE_SERVICE);
+    return install_service(scm, desired_service_config(narrow(get_current_executable())), apply_current, *spdlog::default_logger());
 }
 
 
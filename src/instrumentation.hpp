@@ -0,0 +1,205 @@
+// Copyright (c) 2025 Hygor Ostrowskij de Morais <hygor.o.morais@gmail.com>
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+
+namespace hy {
+
+
+// Process wide counters. Heap counts are only filled in by executables that link alloc_hooks.cpp,
+//   handles and security descriptors by the backends.
+struct ResourceCounters {
+    std::atomic<bool>     allocation_hooks_installed = false;
+    std::atomic<uint64_t> allocations = 0;
+    std::atomic<uint64_t> deallocations = 0;
+    std::atomic<uint64_t> allocated_bytes = 0;
+    std::atomic<uint64_t> handles_opened = 0;
+    std::atomic<uint64_t> handles_closed = 0;
+    std::atomic<uint64_t> descriptors_created = 0;
+    std::atomic<uint64_t> descriptors_freed = 0;
+};
+
+
+inline ResourceCounters& resource_counters() {
+    static ResourceCounters counters;
+    return counters;
+}
+
+
+inline void track_handle_opened()      { resource_counters().handles_opened.fetch_add(1, std::memory_order_relaxed); }
+inline void track_handle_closed()      { resource_counters().handles_closed.fetch_add(1, std::memory_order_relaxed); }
+inline void track_descriptor_created() { resource_counters().descriptors_created.fetch_add(1, std::memory_order_relaxed); }
+inline void track_descriptor_freed()   { resource_counters().descriptors_freed.fetch_add(1, std::memory_order_relaxed); }
+
+
+struct ResourceSnapshot {
+    uint64_t allocations;
+    uint64_t deallocations;
+    uint64_t allocated_bytes;
+    uint64_t handles_opened;
+    uint64_t handles_closed;
+    uint64_t descriptors_created;
+    uint64_t descriptors_freed;
+
+    int64_t live_allocations() const { return static_cast<int64_t>(allocations - deallocations); }
+    int64_t live_handles()     const { return static_cast<int64_t>(handles_opened - handles_closed); }
+    int64_t live_descriptors() const { return static_cast<int64_t>(descriptors_created - descriptors_freed); }
+
+    ResourceSnapshot operator-(const ResourceSnapshot& o) const {
+        return {
+            allocations - o.allocations,
+            deallocations - o.deallocations,
+            allocated_bytes - o.allocated_bytes,
+            handles_opened - o.handles_opened,
+            handles_closed - o.handles_closed,
+            descriptors_created - o.descriptors_created,
+            descriptors_freed - o.descriptors_freed,
+        };
+    }
+};
+
+
+inline ResourceSnapshot take_resource_snapshot() {
+    auto& c = resource_counters();
+    return {
+        c.allocations.load(std::memory_order_relaxed),
+        c.deallocations.load(std::memory_order_relaxed),
+        c.allocated_bytes.load(std::memory_order_relaxed),
+        c.handles_opened.load(std::memory_order_relaxed),
+        c.handles_closed.load(std::memory_order_relaxed),
+        c.descriptors_created.load(std::memory_order_relaxed),
+        c.descriptors_freed.load(std::memory_order_relaxed),
+    };
+}
+
+
+struct PhaseRecord {
+    std::string name;
+    ResourceSnapshot delta;
+    std::chrono::nanoseconds duration;
+};
+
+
+// The latest phases recorded in this process, in completion order. Bounded, library users may apply repeatedly.
+class PhaseLog {
+public:
+    static constexpr size_t max_records = 256;
+
+    void add(PhaseRecord record) {
+        std::scoped_lock lock(mutex);
+        if (records.size() == max_records) {
+            records.erase(records.begin());
+        }
+        records.push_back(std::move(record));
+    }
+
+    std::vector<PhaseRecord> snapshot() const {
+        std::scoped_lock lock(mutex);
+        return records;
+    }
+
+    void clear() {
+        std::scoped_lock lock(mutex);
+        records.clear();
+    }
+
+private:
+    mutable std::mutex mutex;
+    std::vector<PhaseRecord> records;
+};
+
+
+inline PhaseLog& phase_log() {
+    static PhaseLog log;
+    return log;
+}
+
+
+inline std::string format_phase(const PhaseRecord& r) {
+    auto heap = resource_counters().allocation_hooks_installed.load(std::memory_order_relaxed)
+        ? fmt::format("{} allocations ({} bytes, {} not freed)", r.delta.allocations, r.delta.allocated_bytes, r.delta.live_allocations())
+        : std::string("heap not tracked");
+    return fmt::format("Phase {}: {:.3f} ms, {}, {} handles ({} not closed), {} security descriptors ({} not freed)",
+        r.name, std::chrono::duration<double, std::milli>(r.duration).count(), heap,
+        r.delta.handles_opened, r.delta.live_handles(), r.delta.descriptors_created, r.delta.live_descriptors());
+}
+
+
+// Records the resources used between construction and destruction as a phase, and logs it at debug level.
+//   Without a logger the phase goes to whatever the default logger is when it ends.
+class PhaseScope {
+public:
+    explicit PhaseScope(std::string name, spdlog::logger* logger = nullptr)
+        : name(std::move(name)), logger(logger), start_resources(take_resource_snapshot()), start(std::chrono::steady_clock::now())
+    {}
+
+    PhaseScope(const PhaseScope&) = delete;
+    PhaseScope& operator=(const PhaseScope&) = delete;
+
+    ~PhaseScope() {
+        try {
+            finish();
+        } catch (...) {}
+    }
+
+    // Ends the phase early and returns its record.
+    const PhaseRecord& finish() {
+        if (!finished) {
+            finished = true;
+            auto duration = std::chrono::steady_clock::now() - start;
+            auto delta = take_resource_snapshot() - start_resources;
+            record = { std::move(name), delta, duration };
+            phase_log().add(record);
+            (logger ? logger : spdlog::default_logger_raw())->debug(format_phase(record));
+        }
+        return record;
+    }
+
+private:
+    std::string name;
+    spdlog::logger* logger;
+    ResourceSnapshot start_resources;
+    std::chrono::steady_clock::time_point start;
+    bool finished = false;
+    PhaseRecord record;
+};
+
+
+// Limits for expect_within_budget. Leaks default to none allowed.
+struct ResourceBudget {
+    uint64_t max_allocations = UINT64_MAX;
+    uint64_t max_allocated_bytes = UINT64_MAX;
+    int64_t max_live_allocations = INT64_MAX;
+    uint64_t max_handles_opened = UINT64_MAX;
+    int64_t max_live_handles = 0;
+    int64_t max_live_descriptors = 0;
+};
+
+
+// Throws if the phase went over budget, so regressions fail benchmarks instead of creeping in.
+inline void expect_within_budget(const PhaseRecord& r, const ResourceBudget& budget) {
+    auto check = [&](const char* what, auto value, auto limit) {
+        if (value > limit) {
+            throw std::runtime_error(fmt::format("Phase {} over budget: {} {} > {}.", r.name, what, value, limit));
+        }
+    };
+    check("allocations",          r.delta.allocations,        budget.max_allocations);
+    check("allocated bytes",      r.delta.allocated_bytes,    budget.max_allocated_bytes);
+    check("live allocations",     r.delta.live_allocations(), budget.max_live_allocations);
+    check("handles opened",       r.delta.handles_opened,     budget.max_handles_opened);
+    check("live handles",         r.delta.live_handles(),     budget.max_live_handles);
+    check("live descriptors",     r.delta.live_descriptors(), budget.max_live_descriptors);
+}
+
+
+}  // namespace
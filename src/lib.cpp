@@ -0,0 +1,264 @@
+// Copyright (c) 2025 Hygor Ostrowskij de Morais <hygor.o.morais@gmail.com>
+
+#include <interception_driver_fix.h>
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <optional>
+#include <spdlog/spdlog.h>
+#include <spdlog/sinks/null_sink.h>
+#include "callback_sink.hpp"
+#include "core.hpp"
+#ifndef _WIN32
+#include "sim_backend.hpp"
+#endif
+
+
+using namespace hy;
+
+
+namespace {
+
+
+// Structs of the first ABI version, the smallest callers can pass. Newer callers may pass larger ones.
+constexpr uint32_t IDF_CONFIG_MIN_SIZE          = sizeof(idf_config);
+constexpr uint32_t IDF_RESULT_MIN_SIZE          = sizeof(idf_result);
+constexpr uint32_t IDF_STATUS_SNAPSHOT_MIN_SIZE = sizeof(idf_status_snapshot);
+constexpr uint32_t IDF_CALLBACKS_MIN_SIZE       = sizeof(idf_callbacks);
+
+
+// Reads only the part of the caller's struct this library knows about, the rest keeps its value in `out`.
+template<typename T>
+void read_sized(T& out, const T* in) {
+    std::memcpy(&out, in, std::min<size_t>(in->size, sizeof(T)));
+    out.size = sizeof(T);
+}
+
+
+// Writes no more than the caller's struct holds, and leaves its size as is.
+template<typename T>
+void write_sized(T* out, const T& in) {
+    auto size = out->size;
+    std::memcpy(out, &in, std::min<size_t>(size, sizeof(T)));
+    out->size = size;
+}
+
+
+void copy_message(idf_result* result, std::string_view msg) {
+    auto n = std::min(msg.size(), sizeof(result->message) - 1);
+    std::memcpy(result->message, msg.data(), n);
+    result->message[n] = '\0';
+}
+
+
+std::shared_ptr<spdlog::logger> make_logger(const idf_callbacks* callbacks, bool verbose) {
+    spdlog::sink_ptr sink;
+    if (callbacks && callbacks->log) {
+        auto log = callbacks->log;
+        auto user_data = callbacks->user_data;
+        sink = std::make_shared<callback_sink_st>([log, user_data](spdlog::level::level_enum level, std::string_view line) {
+            // spdlog's levels line up with idf_log_level, only "off" is left over.
+            auto idf_level = static_cast<idf_log_level>(std::min<int>(level, IDF_LOG_CRITICAL));
+            auto buffer = std::string(line);
+            log(user_data, idf_level, buffer.c_str(), buffer.size());
+        });
+        sink->set_pattern("%v");
+    } else {
+        sink = std::make_shared<spdlog::sinks::null_sink_st>();
+    }
+
+    auto logger = std::make_shared<spdlog::logger>("idf", std::move(sink));
+    logger->set_level(verbose ? spdlog::level::debug : spdlog::level::info);
+    return logger;
+}
+
+
+NamespaceBackend& default_backend() {
+#ifdef _WIN32
+    static NtNamespaceBackend backend;
+#else
+    static SimNamespace ns;
+    static std::once_flag seeded;
+    std::call_once(seeded, [] { ns.add_default_devices(); });
+    static SimNamespaceBackend backend(ns);
+#endif
+    return backend;
+}
+
+
+const StatusBlockLayout* status_block() {
+    static std::atomic<const StatusBlockLayout*> block = nullptr;
+    static std::mutex mutex;
+    static std::optional<StatusBlockMapping> mapping;
+
+    if (auto p = block.load(std::memory_order_acquire)) {
+        return p;
+    }
+
+    std::scoped_lock lock(mutex);
+    if (!mapping) {
+        mapping = StatusBlockMapping::open_read_only();
+        if (!mapping) {
+            return nullptr;
+        }
+        block.store(mapping->get(), std::memory_order_release);
+    }
+    return mapping->get();
+}
+
+
+void report_metrics(const idf_callbacks* callbacks, const ApplyResult& r) {
+    if (!callbacks || !callbacks->metric) {
+        return;
+    }
+    auto metric = callbacks->metric;
+    auto user_data = callbacks->user_data;
+    metric(user_data, "devices",             r.n_devices);
+    metric(user_data, "symlinks_created",    r.n_symlinks_created);
+    metric(user_data, "symlinks_existing",   r.n_symlinks_existing);
+    metric(user_data, "symlinks_name_taken", r.n_symlinks_name_taken);
+    metric(user_data, "duration_ns",         static_cast<double>(r.duration.count()));
+    metric(user_data, "handles_opened",      static_cast<double>(r.resources.handles_opened));
+    metric(user_data, "handles_leaked",      static_cast<double>(r.resources.live_handles()));
+    metric(user_data, "descriptors_created", static_cast<double>(r.resources.descriptors_created));
+    metric(user_data, "descriptors_leaked",  static_cast<double>(r.resources.live_descriptors()));
+    if (resource_counters().allocation_hooks_installed.load(std::memory_order_relaxed)) {
+        metric(user_data, "allocations",     static_cast<double>(r.resources.allocations));
+        metric(user_data, "allocated_bytes", static_cast<double>(r.resources.allocated_bytes));
+    }
+}
+
+
+idf_config default_config() {
+    auto defaults = default_main_config();
+    idf_config cfg = {};
+    cfg.size                     = sizeof(idf_config);
+    cfg.verbose                  = defaults.verbose;
+    cfg.lockdown                 = defaults.lockdown;
+    cfg.max_interception_devices = defaults.n_max_interception_devices;
+    cfg.keyboard_symlinks        = defaults.n_keyboard_symlinks;
+    cfg.pointer_symlinks         = defaults.n_pointer_symlinks;
+    return cfg;
+}
+
+
+}  // namespace
+
+
+extern "C" {
+
+
+uint32_t idf_abi_version(void) {
+    return IDF_ABI_VERSION;
+}
+
+
+idf_status idf_config_init_sized(idf_config* cfg, size_t size) {
+    if (!cfg || size < IDF_CONFIG_MIN_SIZE || size > UINT32_MAX) {
+        return IDF_INVALID_ARG;
+    }
+    cfg->size = static_cast<uint32_t>(size);
+    write_sized(cfg, default_config());
+    return IDF_OK;
+}
+
+
+idf_status idf_repair(const idf_config* cfg, const idf_callbacks* callbacks, idf_result* result) {
+    idf_result local_result = {};
+    local_result.size = sizeof(idf_result);
+    if (!result) {
+        result = &local_result;
+    }
+    if (result->size < IDF_RESULT_MIN_SIZE) {
+        return IDF_INVALID_ARG;
+    }
+
+    idf_result r = {};
+    r.size = sizeof(idf_result);
+    auto finish = [&] {
+        write_sized(result, r);
+        return static_cast<idf_status>(r.status);
+    };
+
+    if (!cfg || cfg->size < IDF_CONFIG_MIN_SIZE || (callbacks && callbacks->size < IDF_CALLBACKS_MIN_SIZE)) {
+        r.status = IDF_INVALID_ARG;
+        copy_message(&r, "Invalid argument.");
+        return finish();
+    }
+
+    auto c = default_config();
+    read_sized(c, cfg);
+    idf_callbacks cb = {};
+    if (callbacks) {
+        read_sized(cb, callbacks);
+    }
+
+    AppMainConfig main_cfg = {};
+    main_cfg.verbose                    = c.verbose;
+    main_cfg.lockdown                   = c.lockdown;
+    main_cfg.n_max_interception_devices = c.max_interception_devices;
+    main_cfg.n_keyboard_symlinks        = c.keyboard_symlinks;
+    main_cfg.n_pointer_symlinks         = c.pointer_symlinks;
+
+    try {
+        auto logger = make_logger(&cb, main_cfg.verbose);
+        auto a = apply(main_cfg, default_backend(), *logger);
+        logger->info("Success");
+
+        r.status              = IDF_OK;
+        r.devices             = a.n_devices;
+        r.symlinks_created    = a.n_symlinks_created;
+        r.symlinks_existing   = a.n_symlinks_existing;
+        r.symlinks_name_taken = a.n_symlinks_name_taken;
+        r.duration_ns         = static_cast<uint64_t>(a.duration.count());
+        report_metrics(&cb, a);
+    } catch (const std::exception& e) {
+        r.status = IDF_ERROR;
+        copy_message(&r, e.what());
+    } catch (...) {
+        r.status = IDF_ERROR;
+        copy_message(&r, "Unknown error.");
+    }
+
+    return finish();
+}
+
+
+idf_status idf_read_status(idf_status_snapshot* snapshot) {
+    if (!snapshot || snapshot->size < IDF_STATUS_SNAPSHOT_MIN_SIZE) {
+        return IDF_INVALID_ARG;
+    }
+
+    try {
+        auto block = status_block();
+        if (!block) {
+            return IDF_NOT_AVAILABLE;
+        }
+        auto s = read_status_block(*block);
+        if (!s) {
+            return IDF_NOT_AVAILABLE;
+        }
+
+        idf_status_snapshot out = {};
+        out.size                     = sizeof(idf_status_snapshot);
+        out.error_count              = s->error_count;
+        out.generation               = s->generation;
+        out.last_apply_unix_ns       = std::chrono::duration_cast<std::chrono::nanoseconds>(s->last_apply.time_since_epoch()).count();
+        out.last_apply_duration_ns   = s->last_apply_duration.count();
+        out.lockdown                 = s->lockdown;
+        out.max_interception_devices = s->n_max_interception_devices;
+        out.keyboard_symlinks        = s->n_keyboard_symlinks;
+        out.pointer_symlinks         = s->n_pointer_symlinks;
+        out.symlinks_created         = s->n_symlinks_created;
+        out.symlinks_existing        = s->n_symlinks_existing;
+        out.symlinks_name_taken      = s->n_symlinks_name_taken;
+        write_sized(snapshot, out);
+    } catch (...) {
+        return IDF_ERROR;
+    }
+
+    return IDF_OK;
+}
+
+
+}  // extern "C"
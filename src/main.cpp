@@ -1,20 +1,35 @@
 // Copyright (c) 2025 Hygor Ostrowskij de Morais <hygor.o.morais@gmail.com>
 
 #include <hy_windows.h>
+#include <iostream>
 #include <spdlog/spdlog.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/sinks/basic_file_sink.h>
 #include "cli.hpp"
 #include "core.hpp"
 #include "service.hpp"
+#include "footprint.hpp"
 #include "install_uninstall_service.hpp"
+#include "instrumentation.hpp"
+#include "verify.hpp"
 
 
 using namespace hy;
 
 
+// Phases that ended before the log level was known weren't shown, show them now.
+static void enable_verbose_logging() {
+    spdlog::set_level(spdlog::level::debug);
+    for (auto& record : phase_log().snapshot()) {
+        spdlog::debug(format_phase(record));
+    }
+}
+
+
 int wmain(int argc, wchar_t** argv) {
     try {
+        PhaseScope startup_phase("startup");
+
         auto log_path = (std::filesystem::path(get_program_data_folder()) / MY_DATA_DIR_NAME / "logs/interception-driver-fix.log").lexically_normal();
         // std::filesystem::create_directories(log_path.parent_path());
 
@@ -35,31 +50,73 @@ int wmain(int argc, wchar_t** argv) {
 
         spdlog::info("Starting {} version {}.", MY_APP_NAME, MY_APP_VERSION);
         spdlog::info("Command line arguments: {}", narrow(GetCommandLineW()));
+        startup_phase.finish();
 
-        auto [app, main_cfg, install_service_cfg, uninstall_service_cfg] = parse_cli(argc, argv);
+        PhaseScope parse_cli_phase("parse_cli");
+        auto [app, main_cfg, install_service_cfg, uninstall_service_cfg, verify_cfg, footprint_cfg] = parse_cli(argc, argv);
+        parse_cli_phase.finish();
 
         spdlog::set_level(spdlog::level::info);
 
         if (app->got_subcommand("install-service")) {
             if (install_service_cfg.verbose) {
-                spdlog::set_level(spdlog::level::debug);
+                enable_verbose_logging();
             }
 
-            install_service();
+            PhaseScope phase("install_service");
+            install_service(install_service_cfg.main_cfg);
             return 0;
         }
 
         if (app->got_subcommand("uninstall-service")) {
             if (uninstall_service_cfg.verbose) {
-                spdlog::set_level(spdlog::level::debug);
+                enable_verbose_logging();
             }
 
+            PhaseScope phase("uninstall_service");
             uninstall_service();
             return 0;
         }
 
+        if (app->got_subcommand("verify")) {
+            if (verify_cfg.verbose) {
+                enable_verbose_logging();
+            }
+
+            PhaseScope phase("verify");
+            NtNamespaceBackend backend;
+            auto report = verify(verify_cfg.main_cfg, backend);
+            std::cout << format_verify_report(report) << std::endl;
+            spdlog::info("Verify: {} links, {} devices, {} issues, {} notes.", report.n_links_checked, report.n_devices_checked, report.issues.size(), report.notes.size());
+            return verify_exit_code(report);
+        }
+
+        if (app->got_subcommand("footprint")) {
+            if (footprint_cfg.verbose) {
+                enable_verbose_logging();
+            }
+
+            PhaseScope phase("footprint");
+            std::vector<std::string> baseline;
+            if (footprint_cfg.n_baseline_entries > 0) {
+                baseline = synthetic_device_baseline(footprint_cfg.n_baseline_entries);
+            } else {
+                // Links from an earlier run are not part of the baseline.
+                NtNamespaceBackend backend;
+                for (auto& entry : backend.list_directory("\\Device")) {
+                    if (entry.type != ObjectType::symbolic_link || !is_plan_link_name(entry.name)) {
+                        baseline.push_back(std::move(entry.name));
+                    }
+                }
+            }
+
+            auto report = estimate_footprint(footprint_cfg.main_cfg, baseline, footprint_cfg.probe_ns);
+            std::cout << format_footprint_report(report) << std::endl;
+            return 0;
+        }
+
         if (main_cfg.verbose) {
-            spdlog::set_level(spdlog::level::debug);
+            enable_verbose_logging();
         }
 
         SERVICE_TABLE_ENTRYW service_table[] = {
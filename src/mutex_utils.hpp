@@ -4,8 +4,11 @@
 
 #include <hy_windows.h>
 #include <iostream>
+#include <optional>
 #include <sddl.h>
 #include <combaseapi.h>
+#include <sr/scope.h>
+#include "instrumentation.hpp"
 
 
 namespace hy {
@@ -33,9 +36,7 @@ inline std::wstring get_guid() {
 }
 
 
-inline std::wstring get_mutex_name(HKEY root_key, std::wstring stable_key_name, std::wstring volatile_key_name) {
-    constexpr auto sddl = L"D:(A;;FA;;;SY)(A;;FA;;;BA)";  // HARDCODED
-
+inline std::wstring get_mutex_name(HKEY root_key, std::wstring stable_key_name, std::wstring volatile_key_name, const wchar_t* sddl = L"D:(A;;FA;;;SY)(A;;FA;;;BA)") {
     PSECURITY_DESCRIPTOR psd;
     if (!ConvertStringSecurityDescriptorToSecurityDescriptorW(
         sddl,
@@ -45,6 +46,8 @@ inline std::wstring get_mutex_name(HKEY root_key, std::wstring stable_key_name,
     )) {
         throw std::runtime_error("");
     }
+    track_descriptor_created();
+    sr::scope_exit free_psd{ [&] { LocalFree(psd); track_descriptor_freed(); } };
 
     std::wstring mutex_name = L"Global\\" + get_guid();
 
@@ -80,8 +83,10 @@ inline std::wstring get_mutex_name(HKEY root_key, std::wstring stable_key_name,
         &key,
         &disposition
     )) {
+        RegCloseKey(stable_key);
         throw std::runtime_error("");
     }
+    sr::scope_exit close_key{ [&] { RegCloseKey(key); } };
     if (RegCloseKey(stable_key)) { throw std::runtime_error(""); }
     if (disposition != REG_CREATED_NEW_KEY) {
         mutex_name.resize(MAX_PATH);
@@ -96,6 +101,32 @@ inline std::wstring get_mutex_name(HKEY root_key, std::wstring stable_key_name,
 }
 
 
+// Read-only counterpart of get_mutex_name, for processes that only need to find the name.
+inline std::optional<std::wstring> query_mutex_name(HKEY root_key, std::wstring stable_key_name, std::wstring volatile_key_name) {
+    HKEY key = nullptr;
+    if (RegOpenKeyExW(
+        root_key,
+        (stable_key_name + L"\\" + volatile_key_name).c_str(),
+        0,
+        KEY_QUERY_VALUE,
+        &key
+    )) {
+        return std::nullopt;
+    }
+
+    std::wstring mutex_name(MAX_PATH, L'\0');
+    DWORD mutex_name_size = mutex_name.size()+1;
+    auto ret = RegQueryInfoKeyW(key, mutex_name.data(), &mutex_name_size, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr);
+    RegCloseKey(key);
+    if (ret) {
+        return std::nullopt;
+    }
+    mutex_name.resize(mutex_name_size);
+
+    return mutex_name;
+}
+
+
 inline HANDLE wait_for_mutex_creation(std::wstring mutex_name, bool inherit, int timeout) {
     int time_elapsed = 0;
     int polling_interval = 100;
@@ -0,0 +1,377 @@
+// Copyright (c) 2025 Hygor Ostrowskij de Morais <hygor.o.morais@gmail.com>
+
+#pragma once
+
+#include <hy_windows.h>
+#include <ntstatus.h>
+#include <phnt.h>
+#include <sddl.h>
+#include <algorithm>
+#include <cstddef>
+#include <fmt/format.h>
+#include <sr/scope.h>
+#include "backend.hpp"
+#include "instrumentation.hpp"
+#include "utils.hpp"
+
+
+namespace hy {
+
+
+// Handles and security descriptors go through these, so they show up in ResourceCounters.
+inline void close_nt_handle(HANDLE handle) {
+    NtClose(handle);
+    track_handle_closed();
+}
+
+
+inline PSECURITY_DESCRIPTOR sddl_to_security_descriptor(const std::string& sddl) {
+    PSECURITY_DESCRIPTOR psd;
+    if (!ConvertStringSecurityDescriptorToSecurityDescriptorW(
+        widen(sddl).data(),
+        SDDL_REVISION_1,
+        &psd,
+        nullptr
+    )) {
+        throw std::runtime_error("ConvertStringSecurityDescriptorToSecurityDescriptorW error.");
+    }
+    track_descriptor_created();
+
+    return psd;
+}
+
+
+inline void free_security_descriptor(PSECURITY_DESCRIPTOR psd) {
+    LocalFree(psd);
+    track_descriptor_freed();
+}
+
+
+inline SymlinkStatus create_symlink(const std::string& link, const std::string& target) {
+    NTSTATUS ret;
+
+    auto link_name_buffer   = widen(link);
+    auto target_name_buffer = widen(target);
+    UNICODE_STRING link_name;
+    UNICODE_STRING target_name;
+    RtlInitUnicodeString(&link_name,   link_name_buffer.data());
+    RtlInitUnicodeString(&target_name, target_name_buffer.data());
+
+    OBJECT_ATTRIBUTES link_obj_attrs;
+
+    InitializeObjectAttributes(
+        &link_obj_attrs,
+        &link_name,
+        OBJ_PERMANENT,
+        nullptr,
+        nullptr
+    );
+
+    HANDLE link_handle = nullptr;
+    ret = NtCreateSymbolicLinkObject(
+        &link_handle,
+        SYMBOLIC_LINK_ALL_ACCESS,
+        &link_obj_attrs,
+        &target_name
+    );
+
+    // Expected errors for NtCreateSymbolicLinkObject
+    // STATUS_OBJECT_NAME_COLLISION  // A symlink object with the same link name already exists.
+    // STATUS_OBJECT_TYPE_MISMATCH   // A non-symlink object with the same link name already exists.
+
+    if (ret == STATUS_OBJECT_NAME_COLLISION) {
+        return SymlinkStatus::already_exists;
+    }
+    if (ret == STATUS_OBJECT_TYPE_MISMATCH) {
+        return SymlinkStatus::name_taken;
+    }
+    if (ret != STATUS_SUCCESS) {
+        throw nt_status_error("NtCreateSymbolicLinkObject", ret);
+    }
+    track_handle_opened();
+
+    close_nt_handle(link_handle);
+
+    return SymlinkStatus::created;
+}
+
+
+inline void remove_symlink(const std::string& link) {
+    NTSTATUS ret;
+
+    auto link_name_buffer = widen(link);
+    UNICODE_STRING link_name;
+    RtlInitUnicodeString(&link_name, link_name_buffer.data());
+
+    OBJECT_ATTRIBUTES link_obj_attrs;
+
+    InitializeObjectAttributes(
+        &link_obj_attrs,
+        &link_name,
+        0,
+        nullptr,
+        nullptr
+    );
+
+    HANDLE link_handle = nullptr;
+    ret = NtOpenSymbolicLinkObject(
+        &link_handle,
+        DELETE,
+        &link_obj_attrs
+    );
+    if (ret == STATUS_OBJECT_NAME_NOT_FOUND  // No symlink to delete
+        || ret == STATUS_OBJECT_TYPE_MISMATCH  // Not a symlink
+    ) {
+        return;
+    }
+    if (ret < 0) {
+        throw nt_status_error("NtOpenSymbolicLinkObject", ret);
+    }
+    track_handle_opened();
+    sr::scope_exit close_link{ [&] { close_nt_handle(link_handle); } };
+
+    ret = NtMakeTemporaryObject(link_handle);
+    if (ret < 0) {
+        throw nt_status_error("NtMakeTemporaryObject", ret);
+    }
+}
+
+
+inline void set_interception_device_permissions(int idx, const std::string& sddl) {
+    NTSTATUS ret;
+
+    auto psd = sddl_to_security_descriptor(sddl);
+    sr::scope_exit free_psd{ [&] { free_security_descriptor(psd); } };
+
+    auto device_path_str = fmt::format("\\Device\\Interception{:02}", idx);
+    auto device_path_buffer = widen(device_path_str);
+    UNICODE_STRING device_path;
+    RtlInitUnicodeString(&device_path, device_path_buffer.data());
+    HANDLE hDevice = nullptr;
+    IO_STATUS_BLOCK iosb;
+    OBJECT_ATTRIBUTES oa;
+    InitializeObjectAttributes(&oa, &device_path, OBJ_CASE_INSENSITIVE, nullptr, nullptr);
+
+    ret = NtOpenFile(
+        &hDevice,
+        READ_CONTROL | WRITE_DAC | WRITE_OWNER,
+        &oa,
+        &iosb,
+        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+        0
+    );
+    if (ret < 0) {
+        throw nt_status_error("NtOpenFile", ret);
+    }
+    track_handle_opened();
+    sr::scope_exit close_device{ [&] { close_nt_handle(hDevice); } };
+
+    ret = NtSetSecurityObject(hDevice, DACL_SECURITY_INFORMATION, psd);
+    if (ret < 0) {
+        throw nt_status_error("NtSetSecurityObject", ret);
+    }
+}
+
+
+inline ObjectType object_type_from_name(std::wstring_view type_name) {
+    if (type_name == L"Device")       { return ObjectType::device; }
+    if (type_name == L"SymbolicLink") { return ObjectType::symbolic_link; }
+    if (type_name == L"Directory")    { return ObjectType::directory; }
+    return ObjectType::other;
+}
+
+
+inline std::wstring_view to_wstring_view(const UNICODE_STRING& str) {
+    return std::wstring_view(str.Buffer, str.Length / sizeof(WCHAR));
+}
+
+
+// Enumerates a whole object directory, as many entries per NtQueryDirectoryObject call as fit into buffer.
+inline std::vector<DirectoryEntry> list_directory(const std::string& path, std::vector<std::byte>& buffer) {
+    NTSTATUS ret;
+
+    auto dir_name_buffer = widen(path);
+    UNICODE_STRING dir_name;
+    RtlInitUnicodeString(&dir_name, dir_name_buffer.data());
+
+    OBJECT_ATTRIBUTES oa;
+    InitializeObjectAttributes(&oa, &dir_name, OBJ_CASE_INSENSITIVE, nullptr, nullptr);
+
+    HANDLE dir_handle = nullptr;
+    ret = NtOpenDirectoryObject(&dir_handle, DIRECTORY_QUERY, &oa);
+    if (ret < 0) {
+        throw nt_status_error("NtOpenDirectoryObject", ret);
+    }
+    track_handle_opened();
+    sr::scope_exit close_dir{ [&] { close_nt_handle(dir_handle); } };
+
+    std::vector<DirectoryEntry> entries;
+    ULONG context = 0;
+    bool restart = true;
+    while (true) {
+        ULONG return_length = 0;
+        ret = NtQueryDirectoryObject(
+            dir_handle,
+            buffer.data(),
+            static_cast<ULONG>(buffer.size()),
+            false,
+            restart,
+            &context,
+            &return_length
+        );
+        restart = false;
+        if (ret == STATUS_NO_MORE_ENTRIES) {
+            break;
+        }
+        if (ret < 0) {
+            throw nt_status_error("NtQueryDirectoryObject", ret);
+        }
+
+        // The buffer holds an array of entries terminated by a zeroed one.
+        for (auto info = reinterpret_cast<POBJECT_DIRECTORY_INFORMATION>(buffer.data()); info->Name.Buffer; info++) {
+            entries.push_back({ narrow(to_wstring_view(info->Name)), object_type_from_name(to_wstring_view(info->TypeName)) });
+        }
+
+        if (ret != STATUS_MORE_ENTRIES) {
+            break;
+        }
+    }
+
+    return entries;
+}
+
+
+inline std::optional<std::string> query_symlink(const std::string& link, std::wstring& buffer) {
+    NTSTATUS ret;
+
+    auto link_name_buffer = widen(link);
+    UNICODE_STRING link_name;
+    RtlInitUnicodeString(&link_name, link_name_buffer.data());
+
+    OBJECT_ATTRIBUTES oa;
+    InitializeObjectAttributes(&oa, &link_name, OBJ_CASE_INSENSITIVE, nullptr, nullptr);
+
+    HANDLE link_handle = nullptr;
+    ret = NtOpenSymbolicLinkObject(&link_handle, SYMBOLIC_LINK_QUERY, &oa);
+    if (ret == STATUS_OBJECT_NAME_NOT_FOUND || ret == STATUS_OBJECT_TYPE_MISMATCH) {
+        return std::nullopt;
+    }
+    if (ret < 0) {
+        throw nt_status_error("NtOpenSymbolicLinkObject", ret);
+    }
+    track_handle_opened();
+
+    UNICODE_STRING target;
+    target.Buffer = buffer.data();
+    target.Length = 0;
+    target.MaximumLength = static_cast<USHORT>(std::min<size_t>(buffer.size() * sizeof(WCHAR), UNICODE_STRING_MAX_BYTES));
+    ret = NtQuerySymbolicLinkObject(link_handle, &target, nullptr);
+    close_nt_handle(link_handle);
+    if (ret < 0) {
+        throw nt_status_error("NtQuerySymbolicLinkObject", ret);
+    }
+
+    return narrow(to_wstring_view(target));
+}
+
+
+inline std::string security_descriptor_to_dacl_sddl(PSECURITY_DESCRIPTOR psd) {
+    LPWSTR sddl = nullptr;
+    if (!ConvertSecurityDescriptorToStringSecurityDescriptorW(
+        psd,
+        SDDL_REVISION_1,
+        DACL_SECURITY_INFORMATION,
+        &sddl,
+        nullptr
+    )) {
+        throw std::runtime_error("ConvertSecurityDescriptorToStringSecurityDescriptorW error.");
+    }
+    auto result = narrow(sddl);
+    LocalFree(sddl);
+
+    return result;
+}
+
+
+inline std::optional<std::string> query_interception_device_sddl(int idx, std::vector<std::byte>& buffer) {
+    NTSTATUS ret;
+
+    auto device_path_buffer = widen(fmt::format("\\Device\\Interception{:02}", idx));
+    UNICODE_STRING device_path;
+    RtlInitUnicodeString(&device_path, device_path_buffer.data());
+    HANDLE hDevice = nullptr;
+    IO_STATUS_BLOCK iosb;
+    OBJECT_ATTRIBUTES oa;
+    InitializeObjectAttributes(&oa, &device_path, OBJ_CASE_INSENSITIVE, nullptr, nullptr);
+
+    ret = NtOpenFile(
+        &hDevice,
+        READ_CONTROL,
+        &oa,
+        &iosb,
+        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+        0
+    );
+    if (ret == STATUS_OBJECT_NAME_NOT_FOUND) {
+        return std::nullopt;
+    }
+    if (ret < 0) {
+        throw nt_status_error("NtOpenFile", ret);
+    }
+    track_handle_opened();
+
+    ULONG needed = 0;
+    ret = NtQuerySecurityObject(hDevice, DACL_SECURITY_INFORMATION, buffer.data(), static_cast<ULONG>(buffer.size()), &needed);
+    if (ret == STATUS_BUFFER_TOO_SMALL) {
+        buffer.resize(needed);
+        ret = NtQuerySecurityObject(hDevice, DACL_SECURITY_INFORMATION, buffer.data(), static_cast<ULONG>(buffer.size()), &needed);
+    }
+    close_nt_handle(hDevice);
+    if (ret < 0) {
+        throw nt_status_error("NtQuerySecurityObject", ret);
+    }
+
+    return security_descriptor_to_dacl_sddl(buffer.data());
+}
+
+
+struct NtNamespaceBackend : NamespaceBackend {
+    std::vector<std::byte> directory_buffer = std::vector<std::byte>(256 * 1024);
+    std::vector<std::byte> security_buffer  = std::vector<std::byte>(4 * 1024);
+    std::wstring symlink_buffer             = std::wstring(UNICODE_STRING_MAX_CHARS, L'\0');
+
+    SymlinkStatus create_symlink(const std::string& link, const std::string& target) override {
+        return hy::create_symlink(link, target);
+    }
+
+    void remove_symlink(const std::string& link) override {
+        hy::remove_symlink(link);
+    }
+
+    void set_interception_device_permissions(int idx, const std::string& sddl) override {
+        hy::set_interception_device_permissions(idx, sddl);
+    }
+
+    std::vector<DirectoryEntry> list_directory(const std::string& path) override {
+        return hy::list_directory(path, directory_buffer);
+    }
+
+    std::optional<std::string> query_symlink(const std::string& link) override {
+        return hy::query_symlink(link, symlink_buffer);
+    }
+
+    std::optional<std::string> query_interception_device_sddl(int idx) override {
+        return hy::query_interception_device_sddl(idx, security_buffer);
+    }
+
+    // Round trips through a binary security descriptor, so e.g. FRFW comes out as the same hex mask Windows reports.
+    std::string normalize_sddl(const std::string& sddl) override {
+        auto psd = sddl_to_security_descriptor(sddl);
+        sr::scope_exit free_psd{ [&] { free_security_descriptor(psd); } };
+
+        return security_descriptor_to_dacl_sddl(psd);
+    }
+};
+
+
+}  // namespace
@@ -0,0 +1,95 @@
+// Copyright (c) 2025 Hygor Ostrowskij de Morais <hygor.o.morais@gmail.com>
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+
+namespace hy {
+
+
+// Object directories hash names into a fixed number of buckets, each a singly linked chain.
+constexpr size_t OBJECT_DIRECTORY_BUCKETS = 37;  // NUMBER_HASH_BUCKETS
+
+
+inline char upcase_ascii(char c) {
+    return (c >= 'a' && c <= 'z') ? static_cast<char>(c - ('a' - 'A')) : c;
+}
+
+
+// Same hash as ObpLookupDirectoryEntry: case insensitive, 32-bit wraparound.
+//   Only ASCII is upcased here, which covers every name this project creates.
+inline uint32_t object_directory_hash(std::string_view name) {
+    uint32_t hash = 0;
+    for (char c : name) {
+        hash += (hash << 1) + (hash >> 1);
+        hash += static_cast<unsigned char>(upcase_ascii(c));
+    }
+    return hash;
+}
+
+
+inline size_t object_directory_bucket(std::string_view name) {
+    return object_directory_hash(name) % OBJECT_DIRECTORY_BUCKETS;
+}
+
+
+// Models the chains of one object directory, to count how many entries a lookup walks past.
+//   New entries go to the head of their chain, like ObpInsertDirectoryEntry does.
+//   The move-to-front on successful lookups is not modelled, so counts are for a cold chain.
+class ObjectDirectoryModel {
+public:
+    void insert(std::string_view name) {
+        auto key = upcase(name);
+        if (names.insert(key).second) {
+            buckets[object_directory_bucket(key)].push_back(std::move(key));
+        }
+    }
+
+    void remove(std::string_view name) {
+        auto key = upcase(name);
+        if (names.erase(key) == 0) {
+            return;
+        }
+        auto& chain = buckets[object_directory_bucket(key)];
+        chain.erase(std::find(chain.begin(), chain.end(), key));
+    }
+
+    bool contains(std::string_view name) const {
+        return names.contains(upcase(name));
+    }
+
+    // Number of entries compared until name is found, or the chain length on a miss.
+    size_t lookup_probes(std::string_view name) const {
+        auto key = upcase(name);
+        auto& chain = buckets[object_directory_bucket(key)];
+        if (!names.contains(key)) {
+            return chain.size();
+        }
+        // Chains are stored tail first.
+        auto it = std::find(chain.rbegin(), chain.rend(), key);
+        return static_cast<size_t>(it - chain.rbegin()) + 1;
+    }
+
+    size_t chain_length(size_t bucket) const { return buckets[bucket].size(); }
+    size_t size() const { return names.size(); }
+
+private:
+    static std::string upcase(std::string_view name) {
+        std::string key(name);
+        std::transform(key.begin(), key.end(), key.begin(), upcase_ascii);
+        return key;
+    }
+
+    std::array<std::vector<std::string>, OBJECT_DIRECTORY_BUCKETS> buckets;  // Tail first, head last.
+    std::unordered_set<std::string> names;
+};
+
+
+}  // namespace
@@ -0,0 +1,234 @@
+// Copyright (c) 2025 Hygor Ostrowskij de Morais <hygor.o.morais@gmail.com>
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <fmt/format.h>
+#include "config.hpp"
+
+
+namespace hy {
+
+
+// Entries per batch. Each entry holds two short names, so a batch stays within a few dozen KB.
+constexpr size_t DEFAULT_PLAN_BATCH_SIZE = 256;
+
+
+enum class PlanOpKind {
+    set_device_permissions,
+    create_symlink,
+};
+
+
+// One step of real_main, without any names formatted.
+struct PlanOp {
+    PlanOpKind kind;
+    std::string_view family;  // "Interception", "KeyboardClass" or "PointerClass"
+    int idx;                  // Device index, or symlink index for create_symlink.
+    int target_idx;           // create_symlink only.
+
+    void format_name(std::string& out) const {
+        out.clear();
+        if (kind == PlanOpKind::set_device_permissions) {
+            fmt::format_to(std::back_inserter(out), "\\Device\\{}{:02}", family, idx);
+        } else {
+            fmt::format_to(std::back_inserter(out), "\\Device\\{}{}", family, idx);
+        }
+    }
+
+    void format_target(std::string& out) const {
+        out.clear();
+        if (kind == PlanOpKind::create_symlink) {
+            fmt::format_to(std::back_inserter(out), "\\Device\\{}{}", family, target_idx);
+        }
+    }
+};
+
+
+struct PlanEntry {
+    size_t index;        // Position in the plan, to resume from.
+    PlanOp op;
+    std::string name;    // \Device\InterceptionNN, or the symlink name.
+    std::string target;  // Symlink target, empty for devices.
+};
+
+
+// Every operation real_main performs for a config, in order:
+//   InterceptionNN permissions, then KeyboardClassN symlinks, then PointerClassN symlinks.
+//   Symlinks are created in groups of 10 starting at 10, each pointing at index % 10, e.g. KeyboardClass23 -> KeyboardClass3.
+// Nothing is materialized, any operation can be computed from its index.
+class SymlinkPlan {
+public:
+    explicit SymlinkPlan(const AppMainConfig& cfg)
+        : n_devices(std::max(cfg.n_max_interception_devices, 0))
+        , n_keyboard_links(count_links(cfg.n_keyboard_symlinks))
+        , n_pointer_links(count_links(cfg.n_pointer_symlinks))
+    {}
+
+    size_t device_count()        const { return n_devices; }
+    size_t keyboard_link_count() const { return n_keyboard_links; }
+    size_t pointer_link_count()  const { return n_pointer_links; }
+    size_t link_count()          const { return n_keyboard_links + n_pointer_links; }
+    size_t size()                const { return n_devices + link_count(); }
+
+    PlanOp operator[](size_t i) const {
+        if (i < n_devices) {
+            return { PlanOpKind::set_device_permissions, "Interception", static_cast<int>(i), 0 };
+        }
+        i -= n_devices;
+        if (i < n_keyboard_links) {
+            return link_op("KeyboardClass", i);
+        }
+        i -= n_keyboard_links;
+        return link_op("PointerClass", i);
+    }
+
+    class iterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type        = PlanOp;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = void;
+        using reference         = PlanOp;
+
+        iterator() = default;
+        iterator(const SymlinkPlan* plan, size_t i) : plan(plan), i(i) {}
+
+        PlanOp operator*() const { return (*plan)[i]; }
+        PlanOp operator[](difference_type n) const { return (*plan)[i + n]; }
+
+        iterator& operator++() { i++; return *this; }
+        iterator operator++(int) { auto tmp = *this; i++; return tmp; }
+        iterator& operator--() { i--; return *this; }
+        iterator operator--(int) { auto tmp = *this; i--; return tmp; }
+        iterator& operator+=(difference_type n) { i += n; return *this; }
+        iterator& operator-=(difference_type n) { i -= n; return *this; }
+        friend iterator operator+(iterator it, difference_type n) { return it += n; }
+        friend iterator operator+(difference_type n, iterator it) { return it += n; }
+        friend iterator operator-(iterator it, difference_type n) { return it -= n; }
+        friend difference_type operator-(const iterator& a, const iterator& b) { return static_cast<difference_type>(a.i) - static_cast<difference_type>(b.i); }
+        friend bool operator==(const iterator& a, const iterator& b) { return a.i == b.i; }
+        friend auto operator<=>(const iterator& a, const iterator& b) { return a.i <=> b.i; }
+
+    private:
+        const SymlinkPlan* plan = nullptr;
+        size_t i = 0;
+    };
+
+    iterator begin() const { return iterator(this, 0); }
+    iterator end()   const { return iterator(this, size()); }
+
+    class Batches;
+
+    // Streams the plan in batches of formatted entries, starting at index start.
+    //   Only one batch is alive at a time and its strings are reused, so memory stays bounded for any plan size.
+    //   for (auto batch : plan.batches()) { for (auto& entry : batch) { ... } }
+    Batches batches(size_t batch_size = DEFAULT_PLAN_BATCH_SIZE, size_t start = 0) const;
+
+private:
+    static size_t count_links(int n_symlinks) {
+        // Same count as for (i = 10; i < n; i += 10) { for (j = 0; j < 10; j++) }
+        return n_symlinks > 10 ? static_cast<size_t>((n_symlinks - 10 + 9) / 10) * 10 : 0;
+    }
+
+    static PlanOp link_op(std::string_view family, size_t k) {
+        return { PlanOpKind::create_symlink, family, static_cast<int>(10 + k), static_cast<int>(k % 10) };
+    }
+
+    size_t n_devices;
+    size_t n_keyboard_links;
+    size_t n_pointer_links;
+};
+
+static_assert(std::random_access_iterator<SymlinkPlan::iterator>);
+
+
+// Holds a copy of the plan, which is only counts, so SymlinkPlan(cfg).batches() can be kept around.
+class SymlinkPlan::Batches {
+public:
+    Batches(const SymlinkPlan& plan, size_t batch_size, size_t start)
+        : plan(plan), batch_size(std::max<size_t>(batch_size, 1)), next_index(std::min(start, plan.size()))
+    {
+        entries.resize(std::min(this->batch_size, plan.size() - next_index));
+    }
+
+    struct sentinel {};
+
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type        = std::span<const PlanEntry>;
+        using difference_type   = std::ptrdiff_t;
+
+        explicit iterator(Batches* batches) : batches(batches) { batches->fill(); }
+
+        std::span<const PlanEntry> operator*() const { return batches->current(); }
+        iterator& operator++() { batches->fill(); return *this; }
+        void operator++(int) { ++*this; }
+        friend bool operator==(const iterator& it, sentinel) { return it.done(); }
+
+    private:
+        bool done() const { return batches->current().empty(); }
+
+        Batches* batches;
+    };
+
+    iterator begin() { return iterator(this); }
+    sentinel end()   { return {}; }
+
+    // Index of the first entry that hasn't been handed out yet.
+    size_t position() const { return next_index; }
+
+private:
+    friend class iterator;
+
+    void fill() {
+        n_filled = std::min(batch_size, plan.size() - next_index);
+        for (size_t k = 0; k < n_filled; k++) {
+            auto& entry = entries[k];
+            entry.index = next_index + k;
+            entry.op = plan[entry.index];
+            entry.op.format_name(entry.name);
+            entry.op.format_target(entry.target);
+        }
+        next_index += n_filled;
+    }
+
+    std::span<const PlanEntry> current() const {
+        return std::span<const PlanEntry>(entries.data(), n_filled);
+    }
+
+    SymlinkPlan plan;
+    size_t batch_size;
+    size_t next_index;
+    size_t n_filled = 0;
+    std::vector<PlanEntry> entries;
+};
+
+
+inline SymlinkPlan::Batches SymlinkPlan::batches(size_t batch_size, size_t start) const {
+    return Batches(*this, batch_size, start);
+}
+
+
+// True for names (relative to \Device) the plan creates for any config, i.e. KeyboardClassN/PointerClassN with N >= 10.
+inline bool is_plan_link_name(std::string_view name) {
+    for (std::string_view family : { "KeyboardClass", "PointerClass" }) {
+        if (!name.starts_with(family)) {
+            continue;
+        }
+        auto digits = name.substr(family.size());
+        return digits.size() >= 2 && digits[0] != '0'
+            && std::all_of(digits.begin(), digits.end(), [](char c) { return c >= '0' && c <= '9'; });
+    }
+    return false;
+}
+
+
+}  // namespace
@@ -0,0 +1,103 @@
+// Copyright (c) 2025 Hygor Ostrowskij de Morais <hygor.o.morais@gmail.com>
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+#include "bench_utils.hpp"
+#include "config.hpp"
+#include "core.hpp"
+#include "instrumentation.hpp"
+#include "plan.hpp"
+#include "sim_backend.hpp"
+#include "verify.hpp"
+
+
+namespace hy {
+
+
+struct ResourceBenchConfig {
+    AppMainConfig main_cfg;
+    int n_steady_runs = 10;
+    uint64_t max_allocations_per_op = 8;
+    uint64_t max_bytes_per_op = 1024;
+};
+
+
+struct ResourceBenchReport {
+    size_t n_ops;  // Plan size.
+    PhaseRecord fresh;   // First apply, creates everything.
+    PhaseRecord steady;  // Worst of the following applies, which find everything in place.
+    std::string violation;  // Empty when within budget.
+
+    bool ok() const { return violation.empty(); }
+};
+
+
+// Applies to a fresh simulated namespace, then again with everything in place, and checks both against
+//   per operation heap budgets. Neither may leave handles or security descriptors open, and the steady
+//   state applies may not keep any heap allocations either.
+inline ResourceBenchReport run_resource_bench(const ResourceBenchConfig& cfg) {
+    ResourceBenchReport report = {};
+    report.n_ops = SymlinkPlan(cfg.main_cfg).size();
+
+    auto logger = make_null_logger("resource-bench");
+
+    SimNamespace ns;
+    ns.add_default_devices(cfg.main_cfg.n_max_interception_devices);
+    SimNamespaceBackend backend(ns);
+
+    // Measured around apply rather than taken from ApplyResult, so its locals are freed by the end.
+    auto run = [&](const char* name) {
+        PhaseScope phase(name, logger.get());
+        apply(cfg.main_cfg, backend, *logger);
+        return phase.finish();
+    };
+
+    report.fresh = run("apply_fresh");
+    for (int i = 0; i < cfg.n_steady_runs; i++) {
+        auto record = run("apply_steady");
+        if (i == 0 || record.delta.allocations > report.steady.delta.allocations || record.delta.live_allocations() > report.steady.delta.live_allocations()) {
+            report.steady = record;
+        }
+    }
+
+    ResourceBudget budget;
+    budget.max_allocations = cfg.max_allocations_per_op * report.n_ops;
+    budget.max_allocated_bytes = cfg.max_bytes_per_op * report.n_ops;
+    budget.max_live_allocations = INT64_MAX;  // The namespace keeps what the first apply creates.
+    try {
+        expect_within_budget(report.fresh, budget);
+        if (cfg.n_steady_runs > 0) {
+            budget.max_live_allocations = 0;
+            expect_within_budget(report.steady, budget);
+        }
+    } catch (const std::runtime_error& e) {
+        report.violation = e.what();
+    }
+
+    return report;
+}
+
+
+inline std::string format_phase_record(const PhaseRecord& r) {
+    return fmt::format(R"({{"name":"{}","duration_ns":{},"allocations":{},"allocated_bytes":{},"live_allocations":{},"handles_opened":{},"live_handles":{},"descriptors_created":{},"live_descriptors":{}}})",
+        r.name, r.duration.count(), r.delta.allocations, r.delta.allocated_bytes, r.delta.live_allocations(),
+        r.delta.handles_opened, r.delta.live_handles(), r.delta.descriptors_created, r.delta.live_descriptors());
+}
+
+
+inline std::string format_resource_bench_report(const ResourceBenchReport& report) {
+    std::string violation;
+    append_json_string(violation, report.violation);
+    return fmt::format(R"({{"ops":{},"heap_tracked":{},"fresh":{},"steady":{},"ok":{},"violation":{}}})",
+        report.n_ops, resource_counters().allocation_hooks_installed.load(std::memory_order_relaxed),
+        format_phase_record(report.fresh), format_phase_record(report.steady), report.ok(), violation);
+}
+
+
+}  // namespace
@@ -6,6 +6,8 @@
 #include <spdlog/spdlog.h>
 #include "cli.hpp"
 #include "core.hpp"
+#include "service_control.hpp"
+#include "status_block.hpp"
 
 
 namespace hy {
@@ -13,7 +15,49 @@ namespace hy {
 
 struct SERVICE_CONTEXT {
     SERVICE_STATUS_HANDLE hStatus;
-    SERVICE_STATUS status;
+};
+
+
+struct WinServiceControl : ServiceControl {
+    SERVICE_STATUS_HANDLE hStatus;
+
+    explicit WinServiceControl(SERVICE_STATUS_HANDLE hStatus) : hStatus(hStatus) {}
+
+    void set_status(const ServiceStatusReport& report) override {
+        SERVICE_STATUS serviceStatus = {};
+        serviceStatus.dwServiceType = SERVICE_WIN32_OWN_PROCESS;
+        serviceStatus.dwServiceSpecificExitCode = 0;
+        serviceStatus.dwWin32ExitCode = report.exit_code;
+        serviceStatus.dwControlsAccepted = 0;
+        serviceStatus.dwCurrentState = static_cast<DWORD>(report.state);
+        serviceStatus.dwCheckPoint = report.checkpoint;
+        serviceStatus.dwWaitHint = report.wait_hint_ms;
+
+        if (!SetServiceStatus(hStatus, &serviceStatus)) {
+            throw std::runtime_error(fmt::format("SetServiceStatus error ({}).", static_cast<uint32_t>(report.state)));
+        }
+    }
+
+    ServiceStartReason start_reason() override {
+        PSERVICE_START_REASON reason = nullptr;
+        if (!QueryServiceDynamicInformation(hStatus, SERVICE_DYNAMIC_INFORMATION_LEVEL_START_REASON, reinterpret_cast<PVOID*>(&reason))) {
+            return ServiceStartReason::demand;  // Unknown, keep the services.msc behaviour.
+        }
+        auto flags = reason->dwReason;
+        LocalFree(reason);
+
+        if (flags & SERVICE_START_REASON_DEMAND) {
+            return ServiceStartReason::demand;
+        }
+        if (flags & (SERVICE_START_REASON_AUTO | SERVICE_START_REASON_DELAYEDAUTO)) {
+            return ServiceStartReason::auto_start;
+        }
+        return ServiceStartReason::other;
+    }
+
+    void linger(std::chrono::milliseconds duration) override {
+        Sleep(static_cast<DWORD>(duration.count()));
+    }
 };
 
 
@@ -23,42 +67,31 @@ inline DWORD WINAPI ServiceHandler(
     LPVOID   lpEventData,
     LPVOID   lpContext
 ) {
-    auto& ctx = *static_cast<SERVICE_CONTEXT*>(lpContext);
-
-    switch(dwControl) {
-        case SERVICE_CONTROL_INTERROGATE:
-            return NO_ERROR;
-            break;
-    }
-
-    return ERROR_CALL_NOT_IMPLEMENTED;
+    return handle_service_control(dwControl);
 }
 
 
 inline VOID WINAPI ServiceMain(int argc, wchar_t** argv) {
     SERVICE_CONTEXT ctx = {};
-    SERVICE_STATUS_HANDLE hServiceStatus = RegisterServiceCtrlHandlerExW(
+    ctx.hStatus = RegisterServiceCtrlHandlerExW(
         nullptr,
         ServiceHandler,
         &ctx
     );
+    if (!ctx.hStatus) {
+        spdlog::critical("RegisterServiceCtrlHandlerExW error ({}).", GetLastError());
+        return;
+    }
 
-    SERVICE_STATUS serviceStatus = {};
-    serviceStatus.dwServiceType = SERVICE_WIN32_OWN_PROCESS;
-    serviceStatus.dwServiceSpecificExitCode = 0;
-    serviceStatus.dwWin32ExitCode = 1;
-    serviceStatus.dwControlsAccepted = 0;
-    serviceStatus.dwCurrentState = SERVICE_START_PENDING;
-    serviceStatus.dwCheckPoint = 0;
-    serviceStatus.dwWaitHint = 0;
-
-    try {
-        if (!SetServiceStatus(hServiceStatus, &serviceStatus)) { throw std::runtime_error("SetServiceStatus error (start pending)."); }
+    WinServiceControl scm(ctx.hStatus);
+    NtNamespaceBackend backend;
 
-        serviceStatus.dwCurrentState = SERVICE_RUNNING;
-        if (!SetServiceStatus(hServiceStatus, &serviceStatus)) { throw std::runtime_error("SetServiceStatus error (running)."); }
+    std::optional<StatusBlockMapping> status_block;
+    std::optional<StatusBlockWriter> status_writer;
 
-        auto [app, main_cfg, install_service_cfg, uninstall_service_cfg] = parse_cli(argc, argv);
+    auto load_config = [&] {
+        PhaseScope phase("parse_cli");
+        auto [app, main_cfg, install_service_cfg, uninstall_service_cfg, verify_cfg, footprint_cfg] = parse_cli(argc, argv);
 
         if (app->got_subcommand("install-service")) {
             throw std::runtime_error("Unexpected arguments for service.");
@@ -66,25 +99,29 @@ inline VOID WINAPI ServiceMain(int argc, wchar_t** argv) {
         if (app->got_subcommand("uninstall-service")) {
             throw std::runtime_error("Unexpected arguments for service.");
         }
+        if (app->got_subcommand("verify")) {
+            throw std::runtime_error("Unexpected arguments for service.");
+        }
+        if (app->got_subcommand("footprint")) {
+            throw std::runtime_error("Unexpected arguments for service.");
+        }
 
         spdlog::set_level(spdlog::level::info);
         if (main_cfg.verbose) {
             spdlog::set_level(spdlog::level::debug);
         }
 
-        serviceStatus.dwWin32ExitCode = real_main(main_cfg);
+        try {
+            status_block = StatusBlockMapping::open_or_create();
+            status_writer.emplace(*status_block->get());
+        } catch (const std::exception& e) {
+            spdlog::warn("Status block unavailable: {}", e.what());
+        }
 
-        Sleep(3000);  // services.msc UI/UX improvement, so that there's no jarring pop-up when starting this manually.
-    } catch (const std::exception& e) {
-        spdlog::error("Exception: {}", e.what());
-    } catch (...) {
-        spdlog::error("Unknown error.");
-    }
+        return ServiceRunConfig{ main_cfg, status_writer ? &*status_writer : nullptr };
+    };
 
-    serviceStatus.dwCurrentState = SERVICE_STOPPED;
-    if (!SetServiceStatus(hServiceStatus, &serviceStatus)) {
-        spdlog::critical("Failed to set SERVICE_STOPPED status.");
-    }
+    run_service(scm, load_config, backend, *spdlog::default_logger());
 }
 
 
@@ -0,0 +1,76 @@
+// Copyright (c) 2025 Hygor Ostrowskij de Morais <hygor.o.morais@gmail.com>
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+#include "bench_utils.hpp"
+#include "config.hpp"
+#include "service_control.hpp"
+#include "sim_backend.hpp"
+#include "sim_service_control.hpp"
+
+
+namespace hy {
+
+
+struct ServiceBenchConfig {
+    AppMainConfig main_cfg;
+    ServiceStartReason start_reason = ServiceStartReason::auto_start;
+    int n_runs = 100;
+};
+
+
+struct ServiceBenchReport {
+    int n_runs;
+    int n_failed;  // Nonzero exit code.
+    DurationSummary durations;  // Time to SERVICE_STOPPED.
+    std::chrono::nanoseconds max_report_gap;
+    size_t max_status_reports;
+};
+
+
+// Drives run_service through the simulated SCM against a fresh simulated namespace each run.
+inline ServiceBenchReport run_service_bench(const ServiceBenchConfig& cfg) {
+    ServiceBenchReport report = {};
+    report.n_runs = cfg.n_runs;
+
+    auto logger = make_null_logger("service-bench");
+
+    std::vector<std::chrono::nanoseconds> durations;
+    durations.reserve(cfg.n_runs);
+
+    for (int run = 0; run < cfg.n_runs; run++) {
+        SimNamespace ns;
+        ns.add_default_devices(cfg.main_cfg.n_max_interception_devices);
+        SimNamespaceBackend backend(ns);
+        SimServiceControl scm(cfg.start_reason);
+
+        auto exit_code = run_service(scm, [&] { return ServiceRunConfig{ cfg.main_cfg }; }, backend, *logger);
+        if (exit_code != 0) {
+            report.n_failed++;
+        }
+
+        durations.push_back(scm.time_to_stopped());
+        report.max_report_gap = std::max(report.max_report_gap, scm.max_report_gap());
+        report.max_status_reports = std::max(report.max_status_reports, scm.history().size());
+    }
+
+    report.durations = summarize_durations(durations);
+
+    return report;
+}
+
+
+inline std::string format_service_bench_report(const ServiceBenchReport& report) {
+    return fmt::format(R"({{"runs":{},"failed":{},{},"max_report_gap_ns":{},"max_status_reports":{}}})",
+        report.n_runs, report.n_failed, format_duration_summary(report.durations),
+        report.max_report_gap.count(), report.max_status_reports);
+}
+
+
+}  // namespace
@@ -0,0 +1,155 @@
+// Copyright (c) 2025 Hygor Ostrowskij de Morais <hygor.o.morais@gmail.com>
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <spdlog/spdlog.h>
+#include "backend.hpp"
+#include "config.hpp"
+#include "core.hpp"
+#include "plan.hpp"
+#include "status_block.hpp"
+
+
+namespace hy {
+
+
+// Same values as SERVICE_STOPPED etc., so they can be handed to SetServiceStatus as is.
+enum class ServiceState : uint32_t {
+    stopped       = 1,
+    start_pending = 2,
+    stop_pending  = 3,
+    running       = 4,
+};
+
+
+// Same values as SERVICE_CONTROL_*.
+namespace service_control {
+    constexpr uint32_t stop        = 1;
+    constexpr uint32_t interrogate = 4;
+}
+
+constexpr uint32_t SERVICE_NO_ERROR                = 0;    // NO_ERROR
+constexpr uint32_t SERVICE_CALL_NOT_IMPLEMENTED    = 120;  // ERROR_CALL_NOT_IMPLEMENTED
+
+
+enum class ServiceStartReason {
+    demand,      // sc start, services.msc, install-service.
+    auto_start,  // Boot.
+    other,
+};
+
+
+struct ServiceStatusReport {
+    ServiceState state;
+    uint32_t exit_code;
+    uint32_t checkpoint;
+    uint32_t wait_hint_ms;
+};
+
+
+// What ServiceMain needs from the service control manager.
+//   WinServiceControl forwards to the real SCM, SimServiceControl records everything for measurements.
+struct ServiceControl {
+    virtual ~ServiceControl() = default;
+
+    virtual void set_status(const ServiceStatusReport& report) = 0;
+    virtual ServiceStartReason start_reason() = 0;
+    virtual void linger(std::chrono::milliseconds duration) = 0;
+};
+
+
+// Handler for RegisterServiceCtrlHandlerExW. The service stops on its own, so there's nothing to control.
+inline uint32_t handle_service_control(uint32_t control) {
+    switch (control) {
+        case service_control::interrogate:
+            return SERVICE_NO_ERROR;
+    }
+
+    return SERVICE_CALL_NOT_IMPLEMENTED;
+}
+
+
+constexpr auto SERVICE_INITIAL_WAIT_HINT     = std::chrono::milliseconds(2000);
+constexpr auto SERVICE_MIN_WAIT_HINT         = std::chrono::milliseconds(1000);
+constexpr auto SERVICE_PROGRESS_INTERVAL     = std::chrono::milliseconds(100);
+// services.msc UI/UX improvement, so that there's no jarring pop-up when starting this manually.
+constexpr auto SERVICE_DEMAND_START_LINGER   = std::chrono::milliseconds(3000);
+
+
+// What ServiceMain loads after reporting START_PENDING.
+struct ServiceRunConfig {
+    AppMainConfig main_cfg;
+    StatusBlockWriter* status = nullptr;
+};
+
+
+// The oneshot service from start to stop:
+//   START_PENDING with checkpoints while the config is loaded and the plan applied, then STOPPED.
+//   Only demand starts pass through RUNNING and linger, a boot start stops as soon as the fix is applied.
+inline uint32_t run_service(
+    ServiceControl& scm,
+    const std::function<ServiceRunConfig()>& load_config,
+    NamespaceBackend& backend,
+    spdlog::logger& logger
+) {
+    ServiceStatusReport report = {};
+    report.state = ServiceState::start_pending;
+    report.exit_code = 1;
+    report.wait_hint_ms = static_cast<uint32_t>(SERVICE_INITIAL_WAIT_HINT.count());
+
+    try {
+        scm.set_status(report);
+
+        auto run_cfg = load_config();
+
+        auto start = std::chrono::steady_clock::now();
+        auto last_report = start;
+        auto progress = [&](size_t done, size_t total) {
+            auto now = std::chrono::steady_clock::now();
+            if (now - last_report < SERVICE_PROGRESS_INTERVAL) {
+                return;
+            }
+            last_report = now;
+
+            // Twice the remaining time at the current rate, so a momentary stall doesn't trip the SCM.
+            auto elapsed = now - start;
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(elapsed * (total - done) / std::max<size_t>(done, 1));
+            report.checkpoint++;
+            report.wait_hint_ms = static_cast<uint32_t>(std::max(2 * remaining, SERVICE_MIN_WAIT_HINT).count());
+            scm.set_status(report);
+        };
+
+        report.exit_code = real_main(run_cfg.main_cfg, backend, logger, run_cfg.status, progress);
+
+        if (scm.start_reason() == ServiceStartReason::demand) {
+            report.state = ServiceState::running;
+            report.checkpoint = 0;
+            report.wait_hint_ms = 0;
+            scm.set_status(report);
+
+            scm.linger(SERVICE_DEMAND_START_LINGER);
+        }
+    } catch (const std::exception& e) {
+        logger.error("Exception: {}", e.what());
+    } catch (...) {
+        logger.error("Unknown error.");
+    }
+
+    report.state = ServiceState::stopped;
+    report.checkpoint = 0;
+    report.wait_hint_ms = 0;
+    try {
+        scm.set_status(report);
+    } catch (...) {
+        logger.critical("Failed to set SERVICE_STOPPED status.");
+    }
+
+    return report.exit_code;
+}
+
+
+}  // namespace
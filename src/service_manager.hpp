@@ -0,0 +1,206 @@
+// Copyright (c) 2025 Hygor Ostrowskij de Morais <hygor.o.morais@gmail.com>
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <spdlog/spdlog.h>
+#include "constants.hpp"
+#include "service_control.hpp"
+
+
+namespace hy {
+
+
+// Same values as SERVICE_WIN32_OWN_PROCESS, SERVICE_AUTO_START and SERVICE_ERROR_NORMAL.
+constexpr uint32_t SERVICE_TYPE_OWN_PROCESS     = 0x10;
+constexpr uint32_t SERVICE_START_TYPE_AUTO      = 2;
+constexpr uint32_t SERVICE_ERROR_CONTROL_NORMAL = 1;
+
+
+// Everything install_service sets, as QueryServiceConfigW and QueryServiceConfig2W report it.
+struct ServiceConfig {
+    uint32_t service_type;
+    uint32_t start_type;
+    uint32_t error_control;
+    std::string binary_path;
+    std::string display_name;
+    std::string description;
+    std::vector<std::string> required_privileges;
+
+    bool operator==(const ServiceConfig&) const = default;
+};
+
+
+// Only the fields that are set get written.
+struct ServiceConfigUpdate {
+    std::optional<uint32_t> service_type;
+    std::optional<uint32_t> start_type;
+    std::optional<uint32_t> error_control;
+    std::optional<std::string> binary_path;
+    std::optional<std::string> display_name;
+    std::optional<std::string> description;
+    std::optional<std::vector<std::string>> required_privileges;
+
+    // Whether anything ChangeServiceConfigW writes is set, as opposed to ChangeServiceConfig2W.
+    bool has_base_fields() const {
+        return service_type || start_type || error_control || binary_path || display_name;
+    }
+
+    int size() const {
+        return !!service_type + !!start_type + !!error_control + !!binary_path + !!display_name + !!description + !!required_privileges;
+    }
+};
+
+
+inline ServiceConfigUpdate diff_service_config(const ServiceConfig& current, const ServiceConfig& desired) {
+    ServiceConfigUpdate update;
+    if (current.service_type != desired.service_type)               { update.service_type = desired.service_type; }
+    if (current.start_type != desired.start_type)                   { update.start_type = desired.start_type; }
+    if (current.error_control != desired.error_control)             { update.error_control = desired.error_control; }
+    if (current.binary_path != desired.binary_path)                 { update.binary_path = desired.binary_path; }
+    if (current.display_name != desired.display_name)               { update.display_name = desired.display_name; }
+    if (current.description != desired.description)                 { update.description = desired.description; }
+    if (current.required_privileges != desired.required_privileges) { update.required_privileges = desired.required_privileges; }
+    return update;
+}
+
+
+inline ServiceConfig desired_service_config(std::string binary_path) {
+    return {
+        SERVICE_TYPE_OWN_PROCESS,
+        SERVICE_START_TYPE_AUTO,
+        SERVICE_ERROR_CONTROL_NORMAL,
+        std::move(binary_path),
+        MY_SERVICE_DISPLAY_NAME,
+        MY_SERVICE_DESCRIPTION,
+        // ChangeServiceConfig2W fails open silently if any incorrectly named privileges are set, so beware.
+        //   It fails open as if no required privileges were requested, which ends up allowing all privileges.
+        { "SeCreatePermanentPrivilege" },
+    };
+}
+
+
+// The SCM calls install and uninstall need, for this service only.
+//   WinServiceManager forwards to the real SCM, SimServiceManager keeps the service in memory for measurements.
+struct ServiceManager {
+    virtual ~ServiceManager() = default;
+
+    // Both return an empty optional if the service isn't installed.
+    virtual std::optional<ServiceConfig> query_config() = 0;
+    virtual std::optional<ServiceState> query_state() = 0;
+    virtual void create(const ServiceConfig& cfg) = 0;
+    virtual void change_config(const ServiceConfigUpdate& update) = 0;
+    virtual void start() = 0;
+    virtual void stop() = 0;
+    virtual void remove() = 0;
+    // Between query_state polls.
+    virtual void wait(std::chrono::milliseconds duration) = 0;
+};
+
+
+// A running service only stops on its own, after its apply and at most SERVICE_DEMAND_START_LINGER.
+constexpr auto SERVICE_STOP_POLL_INTERVAL = std::chrono::milliseconds(250);
+constexpr auto SERVICE_STOP_TIMEOUT       = std::chrono::seconds(30);
+
+
+struct InstallResult {
+    bool created;
+    int n_fields_changed;
+    bool started;
+};
+
+
+// Polls until the service is stopped or gone. Returns the last state seen, which is still running or pending on timeout.
+inline std::optional<ServiceState> wait_until_stopped(ServiceManager& scm, std::chrono::milliseconds timeout) {
+    auto state = scm.query_state();
+    for (std::chrono::milliseconds waited = {}; state && *state != ServiceState::stopped && waited < timeout; waited += SERVICE_STOP_POLL_INTERVAL) {
+        scm.wait(SERVICE_STOP_POLL_INTERVAL);
+        state = scm.query_state();
+    }
+    return state;
+}
+
+
+// Idempotent, so upgrades only pay for what changed: the configuration is read once, only differing fields are
+//   written, and the service is only started if the fix isn't already applied with the same settings this boot.
+//   A service still running with the configuration that was just changed is waited for and started again,
+//   throws if it doesn't stop in time.
+inline InstallResult install_service(ServiceManager& scm, const ServiceConfig& desired, bool apply_current, spdlog::logger& logger) {
+    logger.info("Installing service.");
+    InstallResult result = {};
+
+    auto current = scm.query_config();
+    if (!current) {
+        scm.create(desired);
+        result.created = true;
+    } else {
+        auto update = diff_service_config(*current, desired);
+        result.n_fields_changed = update.size();
+        if (result.n_fields_changed > 0) {
+            scm.change_config(update);
+        }
+    }
+    logger.debug("Service {}, {} fields changed.", result.created ? "created" : "already installed", result.n_fields_changed);
+
+    // Only a running or starting service is left alone, anything else (stopping, or gone by now) gets a start attempt.
+    std::optional<ServiceState> state = ServiceState::stopped;
+    if (!apply_current && !result.created) {
+        state = scm.query_state();
+    }
+
+    auto running = state == ServiceState::running || state == ServiceState::start_pending;
+    if (running && result.n_fields_changed > 0) {
+        logger.info("Service running with the previous configuration, waiting for it to stop.");
+        state = wait_until_stopped(scm, SERVICE_STOP_TIMEOUT);
+        if (state == ServiceState::running || state == ServiceState::start_pending) {
+            throw std::runtime_error(fmt::format("Service still running after {} s, the new configuration wasn't applied.",
+                std::chrono::duration_cast<std::chrono::seconds>(SERVICE_STOP_TIMEOUT).count()));
+        }
+        running = false;
+    }
+
+    if (apply_current) {
+        logger.info("Fix already applied with the same settings, not starting the service.");
+    } else if (running) {
+        logger.info("Service already running, not starting it again.");
+    } else {
+        if (state != ServiceState::stopped) {
+            logger.warn("Service state is {}, starting it anyway.", state ? fmt::to_string(static_cast<uint32_t>(*state)) : "unknown");
+        }
+        scm.start();
+        result.started = true;
+    }
+
+    logger.info("Installed service successfully.");
+
+    return result;
+}
+
+
+// Returns false if the service wasn't installed.
+inline bool uninstall_service(ServiceManager& scm, spdlog::logger& logger) {
+    logger.info("Uninstalling service.");
+
+    auto state = scm.query_state();
+    if (!state) {
+        logger.info("Service not installed.");
+        return false;
+    }
+
+    if (*state != ServiceState::stopped) {
+        scm.stop();
+    }
+    scm.remove();
+
+    logger.info("Uninstalled service successfully.");
+
+    return true;
+}
+
+
+}  // namespace
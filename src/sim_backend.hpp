@@ -0,0 +1,209 @@
+// Copyright (c) 2025 Hygor Ostrowskij de Morais <hygor.o.morais@gmail.com>
+
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <fmt/format.h>
+#include <sr/scope.h>
+#include "backend.hpp"
+#include "config.hpp"
+#include "instrumentation.hpp"
+
+
+namespace hy {
+
+
+struct SimObject {
+    ObjectType type;
+    std::string target;  // symbolic_link only
+    std::string sddl;    // device only
+};
+
+
+// Ids of open simulated handles or security descriptors. Closed slots are reused, so once the table has grown,
+//   opening and closing doesn't allocate.
+struct SimHandleTable {
+    std::vector<bool> slots;
+    size_t n_open = 0;
+
+    size_t acquire() {
+        n_open++;
+        for (size_t id = 0; id < slots.size(); id++) {
+            if (!slots[id]) {
+                slots[id] = true;
+                return id;
+            }
+        }
+        slots.push_back(true);
+        return slots.size() - 1;
+    }
+
+    // Returns false if id isn't open.
+    bool release(size_t id) {
+        if (id >= slots.size() || !slots[id]) {
+            return false;
+        }
+        slots[id] = false;
+        n_open--;
+        return true;
+    }
+};
+
+
+using SimHandle = size_t;
+using SimDescriptor = size_t;
+
+
+// In-memory stand-in for the object manager namespace, so the core can run without Windows.
+//   Names are stored as full paths (\Device\KeyboardClass0).
+//   Handles and security descriptors stay open until closed or freed explicitly, like their NT counterparts,
+//   so a missing close shows up in n_open_handles() and ResourceCounters. Callers hold mutex for those.
+struct SimNamespace {
+    std::mutex mutex;
+    std::map<std::string, SimObject> objects;
+    SimHandleTable handles;
+    SimHandleTable descriptors;
+
+    void add_device(const std::string& path, std::string sddl = "") {
+        std::scoped_lock lock(mutex);
+        objects.insert_or_assign(path, SimObject{ ObjectType::device, "", std::move(sddl) });
+    }
+
+    // Seeds the devices a machine with the Interception driver and n_devices keyboards/mice would have.
+    void add_default_devices(int n_interception_devices = DEFAULT_MAX_INTERCEPTION_DEVICES, int n_devices = 10) {
+        for (int i = 0; i < n_interception_devices; i++) {
+            add_device(fmt::format("\\Device\\Interception{:02}", i));
+        }
+        for (int i = 0; i < n_devices; i++) {
+            add_device(fmt::format("\\Device\\KeyboardClass{}", i));
+            add_device(fmt::format("\\Device\\PointerClass{}", i));
+        }
+    }
+
+    SimHandle open_handle() {
+        auto handle = handles.acquire();
+        track_handle_opened();
+        return handle;
+    }
+
+    void close_handle(SimHandle handle) {
+        if (!handles.release(handle)) {
+            throw std::runtime_error("NtClose error (STATUS_INVALID_HANDLE).");
+        }
+        track_handle_closed();
+    }
+
+    SimDescriptor create_descriptor() {
+        auto psd = descriptors.acquire();
+        track_descriptor_created();
+        return psd;
+    }
+
+    void free_descriptor(SimDescriptor psd) {
+        if (!descriptors.release(psd)) {
+            throw std::runtime_error("LocalFree error (invalid security descriptor).");
+        }
+        track_descriptor_freed();
+    }
+
+    size_t n_open_handles() {
+        std::scoped_lock lock(mutex);
+        return handles.n_open;
+    }
+
+    size_t n_open_descriptors() {
+        std::scoped_lock lock(mutex);
+        return descriptors.n_open;
+    }
+};
+
+
+// Opens and closes simulated handles and security descriptors where NtNamespaceBackend would, so resource counts line up.
+struct SimNamespaceBackend : NamespaceBackend {
+    SimNamespace& ns;
+
+    explicit SimNamespaceBackend(SimNamespace& ns) : ns(ns) {}
+
+    SymlinkStatus create_symlink(const std::string& link, const std::string& target) override {
+        std::scoped_lock lock(ns.mutex);
+        auto [it, inserted] = ns.objects.try_emplace(link, SimObject{ ObjectType::symbolic_link, target, "" });
+        if (inserted) {
+            ns.close_handle(ns.open_handle());
+            return SymlinkStatus::created;
+        }
+        return it->second.type == ObjectType::symbolic_link ? SymlinkStatus::already_exists : SymlinkStatus::name_taken;
+    }
+
+    void remove_symlink(const std::string& link) override {
+        std::scoped_lock lock(ns.mutex);
+        auto it = ns.objects.find(link);
+        if (it == ns.objects.end() || it->second.type != ObjectType::symbolic_link) {
+            return;
+        }
+        auto handle = ns.open_handle();
+        sr::scope_exit close_link{ [&] { ns.close_handle(handle); } };
+        ns.objects.erase(it);
+    }
+
+    void set_interception_device_permissions(int idx, const std::string& sddl) override {
+        std::scoped_lock lock(ns.mutex);
+        auto psd = ns.create_descriptor();
+        sr::scope_exit free_psd{ [&] { ns.free_descriptor(psd); } };
+        auto path = fmt::format("\\Device\\Interception{:02}", idx);
+        auto it = ns.objects.find(path);
+        if (it == ns.objects.end() || it->second.type != ObjectType::device) {
+            throw std::runtime_error("NtOpenFile error.");
+        }
+        auto handle = ns.open_handle();
+        sr::scope_exit close_device{ [&] { ns.close_handle(handle); } };
+        it->second.sddl = sddl;
+    }
+
+    std::vector<DirectoryEntry> list_directory(const std::string& path) override {
+        std::scoped_lock lock(ns.mutex);
+        auto handle = ns.open_handle();
+        sr::scope_exit close_dir{ [&] { ns.close_handle(handle); } };
+        auto prefix = path + "\\";
+        std::vector<DirectoryEntry> entries;
+        for (auto it = ns.objects.lower_bound(prefix); it != ns.objects.end() && it->first.starts_with(prefix); ++it) {
+            auto name = std::string_view(it->first).substr(prefix.size());
+            if (name.find('\\') == std::string_view::npos) {
+                entries.push_back({ std::string(name), it->second.type });
+            }
+        }
+        return entries;
+    }
+
+    std::optional<std::string> query_symlink(const std::string& link) override {
+        std::scoped_lock lock(ns.mutex);
+        auto it = ns.objects.find(link);
+        if (it == ns.objects.end() || it->second.type != ObjectType::symbolic_link) {
+            return std::nullopt;
+        }
+        auto handle = ns.open_handle();
+        auto target = it->second.target;
+        ns.close_handle(handle);
+        return target;
+    }
+
+    std::optional<std::string> query_interception_device_sddl(int idx) override {
+        std::scoped_lock lock(ns.mutex);
+        auto it = ns.objects.find(fmt::format("\\Device\\Interception{:02}", idx));
+        if (it == ns.objects.end() || it->second.type != ObjectType::device) {
+            return std::nullopt;
+        }
+        auto handle = ns.open_handle();
+        auto sddl = it->second.sddl;
+        ns.close_handle(handle);
+        return sddl;
+    }
+};
+
+
+}  // namespace
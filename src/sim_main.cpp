@@ -0,0 +1,247 @@
+// Copyright (c) 2025 Hygor Ostrowskij de Morais <hygor.o.morais@gmail.com>
+
+// Runs the fix against the simulated object manager, for measurements that can't be done on a live system.
+
+#include <CLI/CLI.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+#include "config.hpp"
+#include "fault_harness.hpp"
+#include "footprint.hpp"
+#include "resource_bench.hpp"
+#include "service_bench.hpp"
+#include "upgrade_bench.hpp"
+
+
+using namespace hy;
+
+
+namespace {
+
+
+void add_main_config_options(CLI::App& app, AppMainConfig& cfg) {
+    app.add_flag("--lockdown",                   cfg.lockdown,                   "");
+    app.add_option("--max-interception-devices", cfg.n_max_interception_devices, "")->capture_default_str();
+    app.add_option("--keyboard-symlinks",        cfg.n_keyboard_symlinks,        "")->capture_default_str();
+    app.add_option("--pointer-symlinks",         cfg.n_pointer_symlinks,         "")->capture_default_str();
+}
+
+
+// The whole of str as a finite number, or an exception naming what was being parsed.
+double parse_number(const std::string& str, const std::string& what) {
+    size_t n = 0;
+    double value = 0;
+    try {
+        value = std::stod(str, &n);
+    } catch (const std::exception&) {
+    }
+    if (n == 0 || n != str.size() || !std::isfinite(value)) {
+        throw std::runtime_error(fmt::format("Invalid number \"{}\" in {}.", str, what));
+    }
+    return value;
+}
+
+
+// fixed:US, uniform:MIN_US:MAX_US or lognormal:MEDIAN_US:SIGMA
+LatencyDistribution parse_latency(const std::string& spec) {
+    std::vector<std::string> parts;
+    for (size_t begin = 0; begin <= spec.size();) {
+        auto end = spec.find(':', begin);
+        if (end == std::string::npos) {
+            end = spec.size();
+        }
+        parts.push_back(spec.substr(begin, end - begin));
+        begin = end + 1;
+    }
+
+    auto invalid = [&](const char* why) {
+        return std::runtime_error(fmt::format("Invalid latency distribution \"{}\", {}.", spec, why));
+    };
+    auto us = [&](const std::string& s) {
+        auto value = parse_number(s, fmt::format("latency distribution \"{}\"", spec));
+        if (value < 0) {
+            throw invalid("durations can't be negative");
+        }
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::duration<double, std::micro>(value));
+    };
+
+    LatencyDistribution latency;
+    if (parts[0] == "fixed" && parts.size() == 2) {
+        latency.kind = LatencyDistribution::Kind::fixed;
+        latency.a = us(parts[1]);
+    } else if (parts[0] == "uniform" && parts.size() == 3) {
+        latency.kind = LatencyDistribution::Kind::uniform;
+        latency.a = us(parts[1]);
+        latency.b = us(parts[2]);
+        if (latency.a > latency.b) {
+            throw invalid("the minimum is above the maximum");
+        }
+    } else if (parts[0] == "lognormal" && parts.size() == 3) {
+        latency.kind = LatencyDistribution::Kind::lognormal;
+        latency.a = us(parts[1]);
+        latency.sigma = parse_number(parts[2], fmt::format("latency distribution \"{}\"", spec));
+        if (latency.sigma <= 0) {
+            throw invalid("sigma has to be positive");
+        }
+    } else {
+        throw invalid("expected fixed:US, uniform:MIN_US:MAX_US or lognormal:MEDIAN_US:SIGMA");
+    }
+    return latency;
+}
+
+
+// One of the ntstatus::named names, or a number, e.g. 0xC0000022.
+uint32_t parse_ntstatus(const std::string& spec) {
+    for (auto [name, status] : ntstatus::named) {
+        if (spec == name) {
+            return status;
+        }
+    }
+
+    size_t n = 0;
+    unsigned long long value = 0;
+    try {
+        value = std::stoull(spec, &n, 0);
+    } catch (const std::exception&) {
+    }
+    if (n == 0 || n != spec.size() || value > UINT32_MAX) {
+        std::string names;
+        for (auto [name, status] : ntstatus::named) {
+            names += names.empty() ? "" : ", ";
+            names += name;
+        }
+        throw std::runtime_error(fmt::format("Invalid NTSTATUS \"{}\", expected a number or one of {}.", spec, names));
+    }
+    return static_cast<uint32_t>(value);
+}
+
+
+// INDEX=STATUS, e.g. 3=0xC0000022 or 3=access_denied
+std::pair<size_t, uint32_t> parse_fail_at(const std::string& spec) {
+    auto eq = spec.find('=');
+    if (eq == std::string::npos) {
+        throw std::runtime_error(fmt::format("Invalid fault \"{}\", expected INDEX=STATUS.", spec));
+    }
+    auto index = spec.substr(0, eq);
+    if (index.empty() || !std::all_of(index.begin(), index.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+        throw std::runtime_error(fmt::format("Invalid fault \"{}\", expected INDEX=STATUS.", spec));
+    }
+    return { std::stoull(index), parse_ntstatus(spec.substr(eq + 1)) };
+}
+
+
+}  // namespace
+
+
+int main(int argc, char** argv) {
+    try {
+        CLI::App app("Interception Driver Fix simulator");
+        app.require_subcommand(1);
+
+        FaultHarnessConfig faults_cfg;
+        faults_cfg.main_cfg = default_main_config();
+        std::string latency_spec;
+        std::string error_status_spec = "insufficient_resources";
+        std::vector<std::string> fail_at_specs;
+        auto faults_subcommand = app.add_subcommand("faults", "Apply repeatedly with injected errors and latency, report run time percentiles and what was left unapplied.");
+        add_main_config_options(*faults_subcommand, faults_cfg.main_cfg);
+        faults_subcommand->add_option("--runs",         faults_cfg.n_runs,            "")->capture_default_str();
+        faults_subcommand->add_option("--seed",         faults_cfg.faults.seed,       "")->capture_default_str();
+        faults_subcommand->add_option("--error-rate",   faults_cfg.faults.error_rate, "Probability of any mutating call failing")->capture_default_str()->check(CLI::Range(0.0, 1.0));
+        faults_subcommand->add_option("--error-status", error_status_spec,            "NTSTATUS for --error-rate failures, a number or e.g. access_denied")->capture_default_str();
+        faults_subcommand->add_option("--fail-at",      fail_at_specs,                "INDEX=STATUS, fail the INDEXth mutating call (the plan index) with STATUS");
+        faults_subcommand->add_option("--latency",      latency_spec,                 "fixed:US, uniform:MIN_US:MAX_US or lognormal:MEDIAN_US:SIGMA");
+
+        ServiceBenchConfig service_cfg;
+        service_cfg.main_cfg = default_main_config();
+        auto service_subcommand = app.add_subcommand("service", "Drive the service through a simulated SCM and report time to SERVICE_STOPPED.");
+        add_main_config_options(*service_subcommand, service_cfg.main_cfg);
+        service_subcommand->add_option("--runs", service_cfg.n_runs, "")->capture_default_str();
+        service_subcommand->add_option("--start-reason", service_cfg.start_reason, "auto or demand")
+            ->transform(CLI::CheckedTransformer(std::map<std::string, ServiceStartReason>{
+                { "auto",   ServiceStartReason::auto_start },
+                { "demand", ServiceStartReason::demand },
+            }));
+
+        AppMainConfig footprint_cfg = default_main_config();
+        size_t n_baseline_entries = 300;
+        double probe_ns = DEFAULT_PROBE_NS;
+        auto footprint_subcommand = app.add_subcommand("footprint", "Estimate what the configured symlinks add to \\Device lookups, against a synthetic \\Device.");
+        add_main_config_options(*footprint_subcommand, footprint_cfg);
+        footprint_subcommand->add_option("--baseline-entries", n_baseline_entries, "")->capture_default_str();
+        footprint_subcommand->add_option("--probe-ns",         probe_ns,           "Cost of walking past one hash chain entry")->capture_default_str();
+
+        ResourceBenchConfig resources_cfg;
+        resources_cfg.main_cfg = default_main_config();
+        auto resources_subcommand = app.add_subcommand("resources", "Apply to a fresh and then an up to date simulated namespace, fail if heap use or leaks go over budget.");
+        add_main_config_options(*resources_subcommand, resources_cfg.main_cfg);
+        resources_subcommand->add_option("--steady-runs",             resources_cfg.n_steady_runs,          "")->capture_default_str();
+        resources_subcommand->add_option("--max-allocations-per-op",  resources_cfg.max_allocations_per_op, "")->capture_default_str();
+        resources_subcommand->add_option("--max-bytes-per-op",        resources_cfg.max_bytes_per_op,       "")->capture_default_str();
+
+        UpgradeBenchConfig upgrade_cfg;
+        upgrade_cfg.main_cfg = default_main_config();
+        double scm_call_us = 0;
+        auto upgrade_subcommand = app.add_subcommand("upgrade", "Run install-service over earlier installs through a simulated SCM and report upgrade latency.");
+        add_main_config_options(*upgrade_subcommand, upgrade_cfg.main_cfg);
+        upgrade_subcommand->add_option("--runs",        upgrade_cfg.n_runs, "")->capture_default_str();
+        upgrade_subcommand->add_option("--scm-call-us", scm_call_us,        "Modeled cost of one SCM round trip")->capture_default_str();
+
+        CLI11_PARSE(app, argc, argv);
+
+        if (faults_subcommand->parsed()) {
+            faults_cfg.faults.random_error_status = parse_ntstatus(error_status_spec);
+            for (auto& spec : fail_at_specs) {
+                faults_cfg.faults.fail_at.insert(parse_fail_at(spec));
+            }
+            if (!latency_spec.empty()) {
+                faults_cfg.faults.latency = parse_latency(latency_spec);
+            }
+
+            auto report = run_fault_harness(faults_cfg);
+            std::cout << format_fault_harness_report(report) << std::endl;
+            return 0;
+        }
+
+        if (footprint_subcommand->parsed()) {
+            auto report = estimate_footprint(footprint_cfg, synthetic_device_baseline(n_baseline_entries), probe_ns);
+            std::cout << format_footprint_report(report) << std::endl;
+            return 0;
+        }
+
+        if (resources_subcommand->parsed()) {
+            auto report = run_resource_bench(resources_cfg);
+            std::cout << format_resource_bench_report(report) << std::endl;
+            if (!report.ok()) {
+                spdlog::error(report.violation);
+                return 3;
+            }
+            return 0;
+        }
+
+        if (upgrade_subcommand->parsed()) {
+            upgrade_cfg.scm_call_latency = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::duration<double, std::micro>(scm_call_us));
+            auto report = run_upgrade_bench(upgrade_cfg);
+            std::cout << format_upgrade_bench_report(report) << std::endl;
+            return 0;
+        }
+
+        if (service_subcommand->parsed()) {
+            auto report = run_service_bench(service_cfg);
+            std::cout << format_service_bench_report(report) << std::endl;
+            return 0;
+        }
+
+        return 0;
+    } catch (const std::exception& e) {
+        spdlog::error("Exception: {}", e.what());
+        return 1;
+    }
+}
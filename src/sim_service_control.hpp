@@ -0,0 +1,95 @@
+// Copyright (c) 2025 Hygor Ostrowskij de Morais <hygor.o.morais@gmail.com>
+
+#pragma once
+
+#include <chrono>
+#include <stdexcept>
+#include <vector>
+#include <fmt/format.h>
+#include "service_control.hpp"
+
+
+namespace hy {
+
+
+// Stands in for the SCM side of a service start. Lingering is accounted for without sleeping,
+//   and every status report is checked against the rules the real SCM enforces.
+class SimServiceControl : public ServiceControl {
+public:
+    struct Event {
+        std::chrono::nanoseconds at;  // Since the simulated start.
+        ServiceStatusReport report;
+    };
+
+    explicit SimServiceControl(ServiceStartReason reason) : reason(reason), start(std::chrono::steady_clock::now()) {}
+
+    void set_status(const ServiceStatusReport& report) override {
+        if (!events.empty()) {
+            auto& prev = events.back().report;
+            if (prev.state == ServiceState::stopped) {
+                throw std::runtime_error("SetServiceStatus after SERVICE_STOPPED.");
+            }
+            if (report.state == ServiceState::start_pending && prev.state == ServiceState::start_pending
+                && report.checkpoint <= prev.checkpoint && report.wait_hint_ms == prev.wait_hint_ms) {
+                throw std::runtime_error(fmt::format("Checkpoint didn't advance ({} -> {}).", prev.checkpoint, report.checkpoint));
+            }
+        } else if (report.state != ServiceState::start_pending) {
+            throw std::runtime_error("First status must be SERVICE_START_PENDING.");
+        }
+        if (report.state == ServiceState::start_pending && report.wait_hint_ms == 0) {
+            throw std::runtime_error("SERVICE_START_PENDING without a wait hint.");
+        }
+
+        events.push_back({ now(), report });
+    }
+
+    ServiceStartReason start_reason() override {
+        return reason;
+    }
+
+    void linger(std::chrono::milliseconds duration) override {
+        lingered += duration;
+    }
+
+    uint32_t control(uint32_t code) {
+        return handle_service_control(code);
+    }
+
+    const std::vector<Event>& history() const { return events; }
+
+    bool stopped() const {
+        return !events.empty() && events.back().report.state == ServiceState::stopped;
+    }
+
+    // From start to SERVICE_STOPPED, including time spent lingering.
+    std::chrono::nanoseconds time_to_stopped() const {
+        if (!stopped()) {
+            throw std::runtime_error("Service didn't stop.");
+        }
+        return events.back().at;
+    }
+
+    // Longest time the SCM went without a status update while the service was pending.
+    std::chrono::nanoseconds max_report_gap() const {
+        std::chrono::nanoseconds gap = {};
+        for (size_t i = 1; i < events.size(); i++) {
+            if (events[i-1].report.state == ServiceState::start_pending) {
+                gap = std::max(gap, events[i].at - events[i-1].at);
+            }
+        }
+        return gap;
+    }
+
+private:
+    std::chrono::nanoseconds now() const {
+        return std::chrono::steady_clock::now() - start + lingered;
+    }
+
+    ServiceStartReason reason;
+    std::chrono::steady_clock::time_point start;
+    std::chrono::nanoseconds lingered = {};
+    std::vector<Event> events;
+};
+
+
+}  // namespace
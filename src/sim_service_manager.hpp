@@ -0,0 +1,153 @@
+// Copyright (c) 2025 Hygor Ostrowskij de Morais <hygor.o.morais@gmail.com>
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <optional>
+#include <stdexcept>
+#include "service_manager.hpp"
+
+
+namespace hy {
+
+
+// Stands in for the SCM during install and uninstall. Calls fail the way the real SCM fails them and are counted,
+//   call_time() models what their round trips would have cost without sleeping. Round trips are the RPCs
+//   WinServiceManager makes for each call, including opening and closing its SCM and service handles.
+class SimServiceManager : public ServiceManager {
+public:
+    struct Calls {
+        int query_config;
+        int query_state;
+        int create;
+        int change_config;
+        int start;
+        int stop;
+        int remove;
+
+        int total() const { return query_config + query_state + create + change_config + start + stop + remove; }
+    };
+
+    // Runs the started service to completion, start() returns once it stopped.
+    std::function<void()> on_start;
+    std::chrono::nanoseconds call_latency = {};
+
+    std::optional<ServiceConfig> installed;
+    ServiceState state = ServiceState::stopped;
+    // How long a running or start pending service takes to stop on its own. Never stops if empty.
+    std::optional<std::chrono::milliseconds> stops_after;
+
+    std::optional<ServiceConfig> query_config() override {
+        calls.query_config++;
+        if (!open()) {
+            return std::nullopt;
+        }
+        n_round_trips += 3;  // QueryServiceConfigW, QueryServiceConfig2W for the description and the privileges.
+        return installed;
+    }
+
+    std::optional<ServiceState> query_state() override {
+        calls.query_state++;
+        if (!open()) {
+            return std::nullopt;
+        }
+        n_round_trips++;
+        return state;
+    }
+
+    void create(const ServiceConfig& cfg) override {
+        calls.create++;
+        n_round_trips++;
+        if (installed) {
+            throw std::runtime_error("CreateServiceW error (ERROR_SERVICE_EXISTS).");
+        }
+        installed = cfg;
+        state = ServiceState::stopped;
+        service_open = true;
+        n_round_trips += 2;  // ChangeServiceConfig2W for the description and the privileges.
+    }
+
+    void change_config(const ServiceConfigUpdate& update) override {
+        calls.change_config++;
+        if (!open()) {
+            throw std::runtime_error("ChangeServiceConfigW error (ERROR_SERVICE_DOES_NOT_EXIST).");
+        }
+        n_round_trips += update.has_base_fields() + !!update.description + !!update.required_privileges;
+        if (update.service_type)        { installed->service_type = *update.service_type; }
+        if (update.start_type)          { installed->start_type = *update.start_type; }
+        if (update.error_control)       { installed->error_control = *update.error_control; }
+        if (update.binary_path)         { installed->binary_path = *update.binary_path; }
+        if (update.display_name)        { installed->display_name = *update.display_name; }
+        if (update.description)         { installed->description = *update.description; }
+        if (update.required_privileges) { installed->required_privileges = *update.required_privileges; }
+    }
+
+    void start() override {
+        calls.start++;
+        if (!open()) {
+            throw std::runtime_error("StartServiceW error (ERROR_SERVICE_DOES_NOT_EXIST).");
+        }
+        if (state != ServiceState::stopped) {
+            throw std::runtime_error("StartServiceW error (ERROR_SERVICE_ALREADY_RUNNING).");
+        }
+        n_round_trips++;
+        state = ServiceState::running;
+        if (on_start) {
+            on_start();
+            state = ServiceState::stopped;
+        }
+    }
+
+    void stop() override {
+        calls.stop++;
+        if (!open()) {
+            throw std::runtime_error("ControlService error (ERROR_SERVICE_DOES_NOT_EXIST).");
+        }
+        n_round_trips++;
+        state = ServiceState::stopped;
+    }
+
+    void remove() override {
+        calls.remove++;
+        if (!open()) {
+            throw std::runtime_error("DeleteService error (ERROR_SERVICE_DOES_NOT_EXIST).");
+        }
+        n_round_trips++;
+        installed.reset();
+    }
+
+    void wait(std::chrono::milliseconds duration) override {
+        waited += duration;
+        if (state != ServiceState::stopped && stops_after && waited >= *stops_after) {
+            state = ServiceState::stopped;
+        }
+    }
+
+    const Calls& call_counts() const { return calls; }
+
+    // So far, plus the CloseServiceHandle calls still to come.
+    int round_trips() const { return n_round_trips + 1 + service_open; }
+
+    // Modeled time spent in SCM round trips and waits.
+    std::chrono::nanoseconds call_time() const { return call_latency * round_trips() + waited; }
+
+private:
+    // OpenServiceW, once it succeeds the handle is kept.
+    bool open() {
+        if (service_open) {
+            return installed.has_value();
+        }
+        n_round_trips++;
+        service_open = installed.has_value();
+        return service_open;
+    }
+
+    Calls calls = {};
+    int n_round_trips = 1;  // OpenSCManagerW
+    bool service_open = false;
+    std::chrono::nanoseconds waited = {};
+};
+
+
+}  // namespace
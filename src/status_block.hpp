@@ -0,0 +1,416 @@
+// Copyright (c) 2025 Hygor Ostrowskij de Morais <hygor.o.morais@gmail.com>
+
+#pragma once
+
+#ifdef _WIN32
+#include <hy_windows.h>
+#include <ntstatus.h>
+#include <phnt.h>
+#include <sddl.h>
+#include "mutex_utils.hpp"
+#include "utils.hpp"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+#include <fmt/format.h>
+#include "config.hpp"
+#include "constants.hpp"
+#include "instrumentation.hpp"
+
+
+namespace hy {
+
+
+constexpr uint32_t STATUS_BLOCK_MAGIC   = 0x53464449;  // "IDFS"
+constexpr uint32_t STATUS_BLOCK_VERSION = 2;  // 2: app_version_hash
+
+
+// FNV-1a of the version string, so the block stays fixed size.
+constexpr uint64_t app_version_hash(std::string_view version) {
+    uint64_t hash = 0xcbf29ce484222325;
+    for (char c : version) {
+        hash = (hash ^ static_cast<uint8_t>(c)) * 0x100000001b3;
+    }
+    return hash;
+}
+
+
+constexpr uint64_t MY_APP_VERSION_HASH = app_version_hash(MY_APP_VERSION);
+
+
+// Shared memory layout, published by the service after every apply.
+//   Fields are only ever appended. Every field is an atomic so that readers never race with the writer,
+//   consistency between fields comes from the seqlock in `sequence` (odd while a write is in progress).
+struct StatusBlockLayout {
+    std::atomic<uint32_t> magic;
+    std::atomic<uint32_t> version;
+    std::atomic<uint64_t> sequence;
+    std::atomic<uint64_t> generation;  // Number of applies since boot.
+    std::atomic<int64_t>  last_apply_unix_ns;
+    std::atomic<int64_t>  last_apply_duration_ns;
+    std::atomic<int32_t>  lockdown;
+    std::atomic<int32_t>  n_max_interception_devices;
+    std::atomic<int32_t>  n_keyboard_symlinks;
+    std::atomic<int32_t>  n_pointer_symlinks;
+    std::atomic<int32_t>  n_symlinks_created;
+    std::atomic<int32_t>  n_symlinks_existing;
+    std::atomic<int32_t>  n_symlinks_name_taken;
+    std::atomic<uint32_t> error_count;
+    std::atomic<uint64_t> app_version_hash;  // Of the binary that did the last apply. Zero in blocks written by version 1.
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "Status block atomics must be address-free.");
+static_assert(std::is_standard_layout_v<StatusBlockLayout>);
+
+
+struct StatusSnapshot {
+    uint64_t generation;
+    std::chrono::system_clock::time_point last_apply;
+    std::chrono::nanoseconds last_apply_duration;
+    bool lockdown;
+    int n_max_interception_devices;
+    int n_keyboard_symlinks;
+    int n_pointer_symlinks;
+    int n_symlinks_created;
+    int n_symlinks_existing;
+    int n_symlinks_name_taken;
+    uint32_t error_count;
+    uint64_t app_version_hash;
+
+    // An apply by another version of the app may have created a different set of links, so it doesn't count.
+    bool matches(const AppMainConfig& cfg, uint64_t version_hash = MY_APP_VERSION_HASH) const {
+        return generation > 0
+            && app_version_hash           == version_hash
+            && lockdown                   == cfg.lockdown
+            && n_max_interception_devices == cfg.n_max_interception_devices
+            && n_keyboard_symlinks        == cfg.n_keyboard_symlinks
+            && n_pointer_symlinks         == cfg.n_pointer_symlinks;
+    }
+};
+
+
+// Owns a mapping of the status block. Readers map it read-only.
+class StatusBlockMapping {
+public:
+    StatusBlockMapping() = default;
+    StatusBlockMapping(const StatusBlockMapping&) = delete;
+    StatusBlockMapping& operator=(const StatusBlockMapping&) = delete;
+    StatusBlockMapping(StatusBlockMapping&& other) noexcept { swap(other); }
+    StatusBlockMapping& operator=(StatusBlockMapping&& other) noexcept { swap(other); return *this; }
+    ~StatusBlockMapping() { close(); }
+
+    // Opens the status block, creating it if this is the first apply since boot.
+    static StatusBlockMapping open_or_create();
+    // Returns an empty optional if the service hasn't published anything since boot.
+    static std::optional<StatusBlockMapping> open_read_only();
+
+    StatusBlockLayout* get() const { return static_cast<StatusBlockLayout*>(view); }
+
+private:
+    void swap(StatusBlockMapping& other) noexcept {
+        std::swap(view, other.view);
+        std::swap(handle, other.handle);
+    }
+
+    void close();
+
+    void* view = nullptr;
+#ifdef _WIN32
+    HANDLE handle = nullptr;
+#else
+    int handle = -1;
+#endif
+};
+
+
+#ifdef _WIN32
+
+inline StatusBlockMapping StatusBlockMapping::open_or_create() {
+    // The section is made permanent (same privilege as the symlinks), so it outlives this oneshot service
+    //   but not the boot, just like the volatile key holding its name.
+    constexpr auto sddl = L"D:(A;;GA;;;SY)(A;;GA;;;BA)(A;;GR;;;WD)";
+    constexpr auto key_sddl = L"D:(A;;KA;;;SY)(A;;KA;;;BA)(A;;KR;;;WD)";
+
+    auto global_name = get_mutex_name(HKEY_LOCAL_MACHINE, widen(MY_REGISTRY_KEY_NAME), widen(MY_STATUS_KEY_NAME), key_sddl);
+    auto section_name_buffer = L"\\BaseNamedObjects\\" + global_name.substr(global_name.find(L'\\') + 1);
+    UNICODE_STRING section_name;
+    RtlInitUnicodeString(&section_name, section_name_buffer.data());
+
+    PSECURITY_DESCRIPTOR psd;
+    if (!ConvertStringSecurityDescriptorToSecurityDescriptorW(sddl, SDDL_REVISION_1, &psd, nullptr)) {
+        throw std::runtime_error("ConvertStringSecurityDescriptorToSecurityDescriptorW error (status block).");
+    }
+    track_descriptor_created();
+
+    OBJECT_ATTRIBUTES oa;
+    InitializeObjectAttributes(&oa, &section_name, OBJ_PERMANENT | OBJ_OPENIF, nullptr, psd);
+
+    LARGE_INTEGER size = {};
+    size.QuadPart = sizeof(StatusBlockLayout);
+
+    StatusBlockMapping mapping;
+    auto create_section = [&] {
+        auto ret = NtCreateSection(
+            &mapping.handle,
+            SECTION_MAP_READ | SECTION_MAP_WRITE | SECTION_QUERY | DELETE,
+            &oa,
+            &size,
+            PAGE_READWRITE,
+            SEC_COMMIT,
+            nullptr
+        );
+        if (ret < 0) {
+            LocalFree(psd);
+            track_descriptor_freed();
+            throw std::runtime_error(fmt::format("NtCreateSection error (0x{:x}).", static_cast<ULONG>(ret)));
+        }
+        track_handle_opened();
+        return ret;
+    };
+
+    // Sections can't grow. One created this boot by a version with a shorter layout is replaced.
+    if (create_section() == STATUS_OBJECT_NAME_EXISTS) {
+        SECTION_BASIC_INFORMATION info = {};
+        if (NT_SUCCESS(NtQuerySection(mapping.handle, SectionBasicInformation, &info, sizeof(info), nullptr))
+            && info.MaximumSize.QuadPart < size.QuadPart) {
+            NtMakeTemporaryObject(mapping.handle);
+            CloseHandle(mapping.handle);
+            track_handle_closed();
+            mapping.handle = nullptr;
+            create_section();
+        }
+    }
+    LocalFree(psd);
+    track_descriptor_freed();
+
+    mapping.view = MapViewOfFile(mapping.handle, FILE_MAP_READ | FILE_MAP_WRITE, 0, 0, sizeof(StatusBlockLayout));
+    if (!mapping.view) {
+        throw std::runtime_error("MapViewOfFile error (status block).");
+    }
+
+    return mapping;
+}
+
+
+inline std::optional<StatusBlockMapping> StatusBlockMapping::open_read_only() {
+    auto global_name = query_mutex_name(HKEY_LOCAL_MACHINE, widen(MY_REGISTRY_KEY_NAME), widen(MY_STATUS_KEY_NAME));
+    if (!global_name) {
+        return std::nullopt;
+    }
+
+    StatusBlockMapping mapping;
+    mapping.handle = OpenFileMappingW(FILE_MAP_READ, false, global_name->c_str());
+    if (!mapping.handle) {
+        return std::nullopt;
+    }
+    track_handle_opened();
+
+    // Fails on a block from a version with a shorter layout, which can't match anyway.
+    mapping.view = MapViewOfFile(mapping.handle, FILE_MAP_READ, 0, 0, sizeof(StatusBlockLayout));
+    if (!mapping.view) {
+        return std::nullopt;
+    }
+
+    return mapping;
+}
+
+
+inline void StatusBlockMapping::close() {
+    if (view) {
+        UnmapViewOfFile(view);
+        view = nullptr;
+    }
+    if (handle) {
+        CloseHandle(handle);
+        track_handle_closed();
+        handle = nullptr;
+    }
+}
+
+#else
+
+inline StatusBlockMapping StatusBlockMapping::open_or_create() {
+    StatusBlockMapping mapping;
+    mapping.handle = shm_open(MY_STATUS_SHM_NAME, O_CREAT | O_RDWR, 0644);
+    if (mapping.handle < 0) {
+        throw std::runtime_error("shm_open error (status block).");
+    }
+    track_handle_opened();
+
+    // Zero-fills on first creation, no-op afterwards.
+    if (ftruncate(mapping.handle, sizeof(StatusBlockLayout)) != 0) {
+        throw std::runtime_error("ftruncate error (status block).");
+    }
+
+    auto view = mmap(nullptr, sizeof(StatusBlockLayout), PROT_READ | PROT_WRITE, MAP_SHARED, mapping.handle, 0);
+    if (view == MAP_FAILED) {
+        throw std::runtime_error("mmap error (status block).");
+    }
+    mapping.view = view;
+
+    return mapping;
+}
+
+
+inline std::optional<StatusBlockMapping> StatusBlockMapping::open_read_only() {
+    StatusBlockMapping mapping;
+    mapping.handle = shm_open(MY_STATUS_SHM_NAME, O_RDONLY, 0);
+    if (mapping.handle < 0) {
+        return std::nullopt;
+    }
+    track_handle_opened();
+
+    struct stat st;
+    if (fstat(mapping.handle, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(StatusBlockLayout))) {
+        return std::nullopt;
+    }
+
+    auto view = mmap(nullptr, sizeof(StatusBlockLayout), PROT_READ, MAP_SHARED, mapping.handle, 0);
+    if (view == MAP_FAILED) {
+        throw std::runtime_error("mmap error (status block).");
+    }
+    mapping.view = view;
+
+    return mapping;
+}
+
+
+inline void StatusBlockMapping::close() {
+    if (view) {
+        munmap(view, sizeof(StatusBlockLayout));
+        view = nullptr;
+    }
+    if (handle >= 0) {
+        ::close(handle);
+        track_handle_closed();
+        handle = -1;
+    }
+}
+
+#endif
+
+
+// Single writer. The service is the only writer, serialized by the SCM.
+//   version_hash is only ever something else in the simulator, to stand in for an older binary.
+class StatusBlockWriter {
+public:
+    explicit StatusBlockWriter(StatusBlockLayout& block, uint64_t version_hash = MY_APP_VERSION_HASH) : block(block), version_hash(version_hash) {
+        if (block.magic.load(std::memory_order_relaxed) != STATUS_BLOCK_MAGIC || block.version.load(std::memory_order_relaxed) != STATUS_BLOCK_VERSION) {
+            write([&] {
+                block.version.store(STATUS_BLOCK_VERSION, std::memory_order_relaxed);
+                block.magic.store(STATUS_BLOCK_MAGIC, std::memory_order_relaxed);
+            });
+        }
+    }
+
+    void record_apply(
+        const AppMainConfig& cfg,
+        int n_symlinks_created,
+        int n_symlinks_existing,
+        int n_symlinks_name_taken,
+        std::chrono::nanoseconds duration
+    ) {
+        auto now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch());
+        write([&] {
+            block.generation.fetch_add(1, std::memory_order_relaxed);
+            block.last_apply_unix_ns.store(now.count(), std::memory_order_relaxed);
+            block.last_apply_duration_ns.store(duration.count(), std::memory_order_relaxed);
+            block.lockdown.store(cfg.lockdown, std::memory_order_relaxed);
+            block.n_max_interception_devices.store(cfg.n_max_interception_devices, std::memory_order_relaxed);
+            block.n_keyboard_symlinks.store(cfg.n_keyboard_symlinks, std::memory_order_relaxed);
+            block.n_pointer_symlinks.store(cfg.n_pointer_symlinks, std::memory_order_relaxed);
+            block.n_symlinks_created.store(n_symlinks_created, std::memory_order_relaxed);
+            block.n_symlinks_existing.store(n_symlinks_existing, std::memory_order_relaxed);
+            block.n_symlinks_name_taken.store(n_symlinks_name_taken, std::memory_order_relaxed);
+            block.app_version_hash.store(version_hash, std::memory_order_relaxed);
+        });
+    }
+
+    void record_error() {
+        write([&] {
+            block.error_count.fetch_add(1, std::memory_order_relaxed);
+        });
+    }
+
+private:
+    // Rounds an odd sequence up first, so a writer that died mid-write doesn't leave the parity inverted for good.
+    template<typename F>
+    void write(F&& f) {
+        auto seq = (block.sequence.load(std::memory_order_relaxed) + 1) & ~uint64_t(1);
+        block.sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        f();
+        block.sequence.store(seq + 2, std::memory_order_release);
+    }
+
+    StatusBlockLayout& block;
+    uint64_t version_hash;
+};
+
+
+// A write only lasts a handful of stores, running out of attempts means the writer died mid-write.
+constexpr int STATUS_BLOCK_READ_ATTEMPTS = 1000;
+
+
+// Returns an empty optional if the block was never initialized, or stayed mid-write for all attempts.
+inline std::optional<StatusSnapshot> read_status_block(const StatusBlockLayout& block) {
+    for (int attempt = 0; attempt < STATUS_BLOCK_READ_ATTEMPTS; attempt++) {
+        if (attempt > 0) {
+            std::this_thread::yield();
+        }
+
+        auto seq_begin = block.sequence.load(std::memory_order_acquire);
+        if (seq_begin & 1) {
+            continue;
+        }
+
+        StatusSnapshot s = {};
+        auto magic                   = block.magic.load(std::memory_order_relaxed);
+        s.generation                 = block.generation.load(std::memory_order_relaxed);
+        s.last_apply                 = std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                                           std::chrono::nanoseconds(block.last_apply_unix_ns.load(std::memory_order_relaxed))));
+        s.last_apply_duration        = std::chrono::nanoseconds(block.last_apply_duration_ns.load(std::memory_order_relaxed));
+        s.lockdown                   = block.lockdown.load(std::memory_order_relaxed);
+        s.n_max_interception_devices = block.n_max_interception_devices.load(std::memory_order_relaxed);
+        s.n_keyboard_symlinks        = block.n_keyboard_symlinks.load(std::memory_order_relaxed);
+        s.n_pointer_symlinks         = block.n_pointer_symlinks.load(std::memory_order_relaxed);
+        s.n_symlinks_created         = block.n_symlinks_created.load(std::memory_order_relaxed);
+        s.n_symlinks_existing        = block.n_symlinks_existing.load(std::memory_order_relaxed);
+        s.n_symlinks_name_taken      = block.n_symlinks_name_taken.load(std::memory_order_relaxed);
+        s.error_count                = block.error_count.load(std::memory_order_relaxed);
+        s.app_version_hash           = block.app_version_hash.load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (block.sequence.load(std::memory_order_relaxed) != seq_begin) {
+            continue;
+        }
+
+        if (magic != STATUS_BLOCK_MAGIC) {
+            return std::nullopt;
+        }
+        return s;
+    }
+
+    return std::nullopt;
+}
+
+
+// Whether the fix was applied with these settings, by this version, since boot. Any failed apply since boot counts
+//   against it, the block doesn't say whether a later apply succeeded.
+inline bool is_apply_current(const StatusBlockLayout& block, const AppMainConfig& cfg) {
+    auto s = read_status_block(block);
+    return s && s->error_count == 0 && s->matches(cfg);
+}
+
+
+}  // namespace
@@ -0,0 +1,153 @@
+// Copyright (c) 2025 Hygor Ostrowskij de Morais <hygor.o.morais@gmail.com>
+
+#pragma once
+
+#include <chrono>
+#include <optional>
+#include <string>
+#include <vector>
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+#include "bench_utils.hpp"
+#include "config.hpp"
+#include "service_control.hpp"
+#include "service_manager.hpp"
+#include "sim_backend.hpp"
+#include "sim_service_control.hpp"
+#include "sim_service_manager.hpp"
+#include "status_block.hpp"
+
+
+namespace hy {
+
+
+struct UpgradeBenchConfig {
+    AppMainConfig main_cfg;
+    int n_runs = 20;
+    std::chrono::nanoseconds scm_call_latency = std::chrono::microseconds(0);
+};
+
+
+enum class UpgradeScenario {
+    fresh_install,     // Nothing installed or applied yet.
+    same_settings,     // Same binary path and settings as what's installed and applied.
+    moved_binary,      // Applied with the same settings by an older version, installed at another path.
+    changed_settings,  // Installed, but applied with other settings.
+};
+
+
+inline const char* to_string(UpgradeScenario scenario) {
+    switch (scenario) {
+        case UpgradeScenario::fresh_install:    return "fresh_install";
+        case UpgradeScenario::same_settings:    return "same_settings";
+        case UpgradeScenario::moved_binary:     return "moved_binary";
+        case UpgradeScenario::changed_settings: return "changed_settings";
+    }
+    return "unknown";
+}
+
+
+struct UpgradeScenarioReport {
+    UpgradeScenario scenario;
+    int n_scm_calls;
+    int n_scm_round_trips;
+    int n_fields_changed;
+    bool started;
+    DurationSummary durations;  // install_service until the fix is applied, plus modeled SCM round trips.
+};
+
+
+struct UpgradeBenchReport {
+    int n_runs;
+    std::vector<UpgradeScenarioReport> scenarios;
+};
+
+
+// Runs install_service against the simulated SCM and a simulated namespace, set up as a previous install left them.
+//   Starting the service runs it to completion through run_service, so a start costs a full apply.
+inline UpgradeScenarioReport run_upgrade_scenario(const UpgradeBenchConfig& cfg, UpgradeScenario scenario, spdlog::logger& logger) {
+    UpgradeScenarioReport report = {};
+    report.scenario = scenario;
+
+    auto desired = desired_service_config("C:\\Program Files\\Interception Driver Fix\\interception-driver-fix.exe");
+    auto previous = desired;
+    auto previous_main_cfg = cfg.main_cfg;
+    auto previous_version_hash = MY_APP_VERSION_HASH;
+    if (scenario == UpgradeScenario::moved_binary) {
+        previous.binary_path = "C:\\Program Files\\Interception Driver Fix 1.0\\interception-driver-fix.exe";
+        previous_version_hash = app_version_hash("1.0");
+    }
+    if (scenario == UpgradeScenario::changed_settings) {
+        previous_main_cfg.lockdown = !previous_main_cfg.lockdown;
+    }
+
+    std::vector<std::chrono::nanoseconds> durations;
+    durations.reserve(cfg.n_runs);
+
+    for (int run = 0; run < cfg.n_runs; run++) {
+        SimNamespace ns;
+        ns.add_default_devices(cfg.main_cfg.n_max_interception_devices);
+        SimNamespaceBackend backend(ns);
+        StatusBlockLayout block = {};
+        StatusBlockWriter previous_status(block, previous_version_hash);
+        StatusBlockWriter status(block);
+
+        auto run_service_once = [&](const AppMainConfig& main_cfg, StatusBlockWriter& writer) {
+            SimServiceControl control(ServiceStartReason::demand);
+            run_service(control, [&] { return ServiceRunConfig{ main_cfg, &writer }; }, backend, logger);
+        };
+
+        SimServiceManager scm;
+        scm.call_latency = cfg.scm_call_latency;
+        if (scenario != UpgradeScenario::fresh_install) {
+            scm.installed = previous;
+            run_service_once(previous_main_cfg, previous_status);
+        }
+        scm.on_start = [&] { run_service_once(cfg.main_cfg, status); };
+
+        auto start = std::chrono::steady_clock::now();
+        auto result = install_service(scm, desired, is_apply_current(block, cfg.main_cfg), logger);
+        durations.push_back(std::chrono::steady_clock::now() - start + scm.call_time());
+
+        report.n_scm_calls = scm.call_counts().total();
+        report.n_scm_round_trips = scm.round_trips();
+        report.n_fields_changed = result.n_fields_changed;
+        report.started = result.started;
+    }
+
+    report.durations = summarize_durations(durations);
+
+    return report;
+}
+
+
+inline UpgradeBenchReport run_upgrade_bench(const UpgradeBenchConfig& cfg) {
+    UpgradeBenchReport report = {};
+    report.n_runs = cfg.n_runs;
+
+    auto logger = make_null_logger("upgrade-bench");
+
+    for (auto scenario : { UpgradeScenario::fresh_install, UpgradeScenario::same_settings, UpgradeScenario::moved_binary, UpgradeScenario::changed_settings }) {
+        report.scenarios.push_back(run_upgrade_scenario(cfg, scenario, *logger));
+    }
+
+    return report;
+}
+
+
+inline std::string format_upgrade_bench_report(const UpgradeBenchReport& report) {
+    std::string out = fmt::format(R"({{"runs":{},"scenarios":[)", report.n_runs);
+    for (size_t i = 0; i < report.scenarios.size(); i++) {
+        auto& s = report.scenarios[i];
+        if (i > 0) {
+            out += ',';
+        }
+        out += fmt::format(R"({{"scenario":"{}","scm_calls":{},"scm_round_trips":{},"fields_changed":{},"started":{},{}}})",
+            to_string(s.scenario), s.n_scm_calls, s.n_scm_round_trips, s.n_fields_changed, s.started, format_duration_summary(s.durations));
+    }
+    out += "]}";
+    return out;
+}
+
+
+}  // namespace
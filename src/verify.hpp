@@ -0,0 +1,238 @@
+// Copyright (c) 2025 Hygor Ostrowskij de Morais <hygor.o.morais@gmail.com>
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <fmt/format.h>
+#include "backend.hpp"
+#include "config.hpp"
+#include "core.hpp"
+#include "plan.hpp"
+
+
+namespace hy {
+
+
+// How far a multi-hop chain is followed to report where it ends up. Also stops symlink loops.
+constexpr int VERIFY_MAX_HOPS = 8;
+
+
+enum class VerifyIssueKind {
+    missing_link,    // No object with the link name.
+    name_taken,      // Something other than a symlink holds the link name, e.g. a real KeyboardClass10. Not a failure, apply skips it too.
+    wrong_target,    // The link resolves to something other than what real_main creates.
+    multi_hop,       // The link points at another symlink, actual is where the chain ends up.
+    missing_device,  // \Device\InterceptionNN doesn't exist.
+    dacl_drift,      // \Device\InterceptionNN DACL doesn't match the lockdown setting.
+};
+
+
+inline const char* to_string(VerifyIssueKind kind) {
+    switch (kind) {
+        case VerifyIssueKind::missing_link:   return "missing_link";
+        case VerifyIssueKind::name_taken:     return "name_taken";
+        case VerifyIssueKind::wrong_target:   return "wrong_target";
+        case VerifyIssueKind::multi_hop:      return "multi_hop";
+        case VerifyIssueKind::missing_device: return "missing_device";
+        case VerifyIssueKind::dacl_drift:     return "dacl_drift";
+    }
+    return "unknown";
+}
+
+
+struct VerifyIssue {
+    VerifyIssueKind kind;
+    std::string name;
+    std::string actual;
+    std::string expected;
+};
+
+
+struct VerifyReport {
+    int n_links_checked;
+    int n_devices_checked;
+    std::vector<VerifyIssue> issues;
+    std::vector<VerifyIssue> notes;  // Outcomes apply considers normal, they don't affect ok().
+
+    bool ok() const { return issues.empty(); }
+};
+
+
+struct StringHash {
+    using is_transparent = void;
+    size_t operator()(std::string_view sv) const { return std::hash<std::string_view>{}(sv); }
+};
+
+
+class Verifier {
+public:
+    Verifier(NamespaceBackend& backend, VerifyReport& report) : backend(backend), report(report) {
+        // One bulk enumeration instead of probing every name.
+        for (auto& entry : backend.list_directory("\\Device")) {
+            device_dir.emplace(std::move(entry.name), entry.type);
+        }
+    }
+
+    void check_link(const PlanEntry& entry) {
+        report.n_links_checked++;
+        name = entry.name;
+
+        auto it = device_dir.find(relative_name(entry.name));
+        if (it == device_dir.end()) {
+            add_issue(VerifyIssueKind::missing_link, "", entry.target);
+            return;
+        }
+        if (it->second != ObjectType::symbolic_link) {
+            report.notes.push_back({ VerifyIssueKind::name_taken, name, "", entry.target });
+            return;
+        }
+
+        auto target = backend.query_symlink(entry.name);
+        if (!target) {
+            add_issue(VerifyIssueKind::missing_link, "", entry.target);
+            return;
+        }
+        if (*target != entry.target) {
+            add_issue(VerifyIssueKind::wrong_target, *target, entry.target);
+            return;
+        }
+
+        auto target_it = device_dir.find(relative_name(entry.target));
+        if (target_it != device_dir.end() && target_it->second == ObjectType::symbolic_link) {
+            add_issue(VerifyIssueKind::multi_hop, resolve_chain(entry.target), entry.target);
+        }
+    }
+
+    void check_device(const PlanEntry& entry, const std::string& expected_sddl) {
+        report.n_devices_checked++;
+        name = entry.name;
+
+        auto sddl = backend.query_interception_device_sddl(entry.op.idx);
+        if (!sddl) {
+            add_issue(VerifyIssueKind::missing_device, "", "");
+            return;
+        }
+        if (*sddl != expected_sddl) {
+            add_issue(VerifyIssueKind::dacl_drift, *sddl, expected_sddl);
+        }
+    }
+
+private:
+    static std::string_view relative_name(std::string_view path) {
+        constexpr std::string_view prefix = "\\Device\\";
+        return path.starts_with(prefix) ? path.substr(prefix.size()) : path;
+    }
+
+    std::string resolve_chain(std::string link) {
+        for (int hop = 0; hop < VERIFY_MAX_HOPS; hop++) {
+            auto next = backend.query_symlink(link);
+            if (!next) {
+                break;
+            }
+            link = std::move(*next);
+        }
+        return link;
+    }
+
+    void add_issue(VerifyIssueKind kind, std::string actual, std::string expected) {
+        report.issues.push_back({ kind, name, std::move(actual), std::move(expected) });
+    }
+
+    NamespaceBackend& backend;
+    VerifyReport& report;
+    std::unordered_map<std::string, ObjectType, StringHash, std::equal_to<>> device_dir;
+    std::string name;
+};
+
+
+// Read-only: checks that everything real_main would have done with cfg is in place.
+inline VerifyReport verify(const AppMainConfig& cfg, NamespaceBackend& backend) {
+    VerifyReport report = {};
+    Verifier verifier(backend, report);
+
+    auto expected_sddl = backend.normalize_sddl(interception_sddl(cfg.lockdown));
+
+    SymlinkPlan plan(cfg);
+    for (auto batch : plan.batches()) {
+        for (auto& entry : batch) {
+            if (entry.op.kind == PlanOpKind::set_device_permissions) {
+                verifier.check_device(entry, expected_sddl);
+            } else {
+                verifier.check_link(entry);
+            }
+        }
+    }
+
+    return report;
+}
+
+
+inline void append_json_string(std::string& out, std::string_view str) {
+    out += '"';
+    for (auto c : str) {
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n";  break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    fmt::format_to(std::back_inserter(out), "\\u{:04x}", static_cast<int>(c));
+                } else {
+                    out += c;
+                }
+        }
+    }
+    out += '"';
+}
+
+
+inline void append_verify_issues(std::string& out, const std::vector<VerifyIssue>& issues) {
+    out += '[';
+    bool first = true;
+    for (auto& issue : issues) {
+        out += first ? "{" : ",{";
+        first = false;
+
+        out += R"("kind":)";
+        append_json_string(out, to_string(issue.kind));
+        out += R"(,"name":)";
+        append_json_string(out, issue.name);
+        if (!issue.actual.empty()) {
+            out += R"(,"actual":)";
+            append_json_string(out, issue.actual);
+        }
+        if (!issue.expected.empty()) {
+            out += R"(,"expected":)";
+            append_json_string(out, issue.expected);
+        }
+        out += '}';
+    }
+    out += ']';
+}
+
+
+// 0 if everything is in place, 2 if issues were found.
+inline int verify_exit_code(const VerifyReport& report) {
+    return report.ok() ? 0 : 2;
+}
+
+
+// Single line JSON, e.g.
+//   {"ok":false,"links":1980,"devices":20,"issues":[{"kind":"missing_link","name":"\\Device\\KeyboardClass10","expected":"\\Device\\KeyboardClass0"}],"notes":[]}
+inline std::string format_verify_report(const VerifyReport& report) {
+    std::string out;
+    fmt::format_to(std::back_inserter(out), R"({{"ok":{},"links":{},"devices":{},"issues":)",
+        report.ok(), report.n_links_checked, report.n_devices_checked);
+    append_verify_issues(out, report.issues);
+    out += R"(,"notes":)";
+    append_verify_issues(out, report.notes);
+    out += '}';
+    return out;
+}
+
+
+}  // namespace
@@ -0,0 +1,129 @@
+// Copyright (c) 2025 Hygor Ostrowskij de Morais <hygor.o.morais@gmail.com>
+
+// The C API against the simulated namespace it uses off Windows: struct sizes in both directions, optional
+//   arguments and callbacks.
+
+#include <cstddef>
+#include <cstring>
+#include <set>
+#include <string>
+#include <interception_driver_fix.h>
+#include "test_utils.hpp"
+
+
+using namespace hy;
+
+
+struct Recorded {
+    int n_log_lines = 0;
+    std::set<std::string> metric_names;
+    double symlinks_created = -1;
+};
+
+
+static void record_log(void* user_data, idf_log_level, const char* msg, size_t msg_len) {
+    auto& recorded = *static_cast<Recorded*>(user_data);
+    if (std::strlen(msg) == msg_len) {
+        recorded.n_log_lines++;
+    }
+}
+
+
+static void record_metric(void* user_data, const char* name, double value) {
+    auto& recorded = *static_cast<Recorded*>(user_data);
+    recorded.metric_names.insert(name);
+    if (std::string(name) == "symlinks_created") {
+        recorded.symlinks_created = value;
+    }
+}
+
+
+// A newer caller's struct with fields this library doesn't know about.
+struct LargerResult {
+    idf_result result;
+    unsigned char appended[32];
+};
+
+
+int main() {
+    idf_config cfg;
+    expect(idf_config_init_sized(&cfg, offsetof(idf_config, pointer_symlinks)) == IDF_INVALID_ARG, "config_init rejects a smaller config");
+    expect(idf_config_init(&cfg) == IDF_OK && cfg.size == sizeof(idf_config), "config_init");
+    expect(cfg.max_interception_devices == 20 && cfg.keyboard_symlinks == 1000, "config_init fills in the defaults");
+    cfg.keyboard_symlinks = 25;  // KeyboardClass10..29
+    cfg.pointer_symlinks = 10;   // None
+
+    {
+        Recorded recorded;
+        idf_callbacks callbacks = {};
+        callbacks.size = sizeof(callbacks);
+        callbacks.log = record_log;
+        callbacks.metric = record_metric;
+        callbacks.user_data = &recorded;
+
+        idf_result result = {};
+        result.size = sizeof(result);
+        expect(idf_repair(&cfg, &callbacks, &result) == IDF_OK, "first repair");
+        expect(result.status == IDF_OK && result.message[0] == '\0', "first repair status");
+        expect(result.devices == 20, "first repair devices");
+        expect(result.symlinks_created == 20 && result.symlinks_existing == 0 && result.symlinks_name_taken == 0, "first repair creates the links");
+
+        expect(recorded.n_log_lines > 0, "log callback called");
+        expect(recorded.symlinks_created == 20, "symlinks_created metric");
+        // This test doesn't link alloc_hooks.cpp, so there are no heap metrics.
+        std::set<std::string> metric_names = {
+            "devices", "symlinks_created", "symlinks_existing", "symlinks_name_taken", "duration_ns",
+            "handles_opened", "handles_leaked", "descriptors_created", "descriptors_leaked",
+        };
+        expect(recorded.metric_names == metric_names, "metric names");
+    }
+
+    {
+        idf_result result = {};
+        result.size = sizeof(result);
+        expect(idf_repair(&cfg, nullptr, &result) == IDF_OK, "second repair");
+        expect(result.symlinks_created == 0 && result.symlinks_existing == 20, "second repair finds the links");
+    }
+
+    expect(idf_repair(&cfg, nullptr, nullptr) == IDF_OK, "repair without a result");
+
+    {
+        LargerResult larger;
+        std::memset(&larger, 0xAB, sizeof(larger));
+        larger.result.size = sizeof(larger);
+        expect(idf_repair(&cfg, nullptr, &larger.result) == IDF_OK, "repair with a larger result");
+        expect(larger.result.size == sizeof(larger), "larger result keeps its size");
+        expect(larger.result.symlinks_existing == 20 && larger.result.message[0] == '\0', "larger result filled in");
+        bool untouched = true;
+        for (auto b : larger.appended) {
+            untouched = untouched && b == 0xAB;
+        }
+        expect(untouched, "fields past idf_result left alone");
+    }
+
+    {
+        idf_result smaller;
+        std::memset(&smaller, 0xAB, sizeof(smaller));
+        smaller.size = offsetof(idf_result, message);
+        expect(idf_repair(&cfg, nullptr, &smaller) == IDF_INVALID_ARG, "repair rejects a smaller result");
+        expect(smaller.size == offsetof(idf_result, message) && smaller.status == static_cast<int32_t>(0xABABABAB), "smaller result not written");
+    }
+
+    {
+        auto small_cfg = cfg;
+        small_cfg.size = offsetof(idf_config, pointer_symlinks);
+        idf_result result = {};
+        result.size = sizeof(result);
+        expect(idf_repair(&small_cfg, nullptr, &result) == IDF_INVALID_ARG, "repair rejects a smaller config");
+        expect(result.status == IDF_INVALID_ARG && result.message[0] != '\0', "smaller config reported in the result");
+        expect(idf_repair(nullptr, nullptr, &result) == IDF_INVALID_ARG, "repair rejects a missing config");
+    }
+
+    {
+        idf_callbacks callbacks = {};
+        callbacks.size = offsetof(idf_callbacks, user_data);
+        expect(idf_repair(&cfg, &callbacks, nullptr) == IDF_INVALID_ARG, "repair rejects smaller callbacks");
+    }
+
+    return test_exit_code();
+}
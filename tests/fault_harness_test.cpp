@@ -0,0 +1,79 @@
+// Copyright (c) 2025 Hygor Ostrowskij de Morais <hygor.o.morais@gmail.com>
+
+// The fault harness with failures at known plan indices: exactly what follows the failure is left unapplied.
+
+#include <map>
+#include <string>
+#include <fmt/format.h>
+#include "config.hpp"
+#include "fault_backend.hpp"
+#include "fault_harness.hpp"
+#include "test_utils.hpp"
+
+
+using namespace hy;
+
+
+// name -> n_runs for every name in [first, last] of a family.
+static std::map<std::string, int> names(const char* format, int first, int last, int n_runs) {
+    std::map<std::string, int> out;
+    for (int i = first; i <= last; i++) {
+        out[fmt::format(fmt::runtime(format), i)] = n_runs;
+    }
+    return out;
+}
+
+
+int main() {
+    // Plan: Interception00..04 (0-4), KeyboardClass10..29 (5-24), PointerClass10..19 (25-34).
+    FaultHarnessConfig cfg;
+    cfg.main_cfg = default_main_config();
+    cfg.main_cfg.n_max_interception_devices = 5;
+    cfg.main_cfg.n_keyboard_symlinks = 25;
+    cfg.main_cfg.n_pointer_symlinks = 15;
+    cfg.n_runs = 3;
+    cfg.faults.seed = 42;
+
+    {
+        auto c = cfg;
+        c.faults.fail_at[3] = ntstatus::access_denied;
+        auto report = run_fault_harness(c);
+        expect(report.n_runs == 3 && report.n_failed == 3, "failure at a device: every run fails");
+        expect(report.failures_by_status == std::map<uint32_t, int>{ { ntstatus::access_denied, 3 } }, "failure at a device: status counted");
+        expect(report.unapplied_devices == names("\\Device\\Interception{:02}", 3, 4, 3), "failure at a device: the device and the ones after it");
+        auto links = names("\\Device\\KeyboardClass{}", 10, 29, 3);
+        links.merge(names("\\Device\\PointerClass{}", 10, 19, 3));
+        expect(report.unapplied_links == links, "failure at a device: every link");
+    }
+
+    {
+        auto c = cfg;
+        c.faults.fail_at[15] = ntstatus::insufficient_resources;
+        c.faults.fail_at[1000] = ntstatus::io_timeout;  // Past the end of the plan, never reached.
+        auto report = run_fault_harness(c);
+        expect(report.n_failed == 3, "failure at a link: every run fails");
+        expect(report.failures_by_status == std::map<uint32_t, int>{ { ntstatus::insufficient_resources, 3 } }, "failure at a link: status counted");
+        expect(report.unapplied_devices.empty(), "failure at a link: every device applied");
+        auto links = names("\\Device\\KeyboardClass{}", 20, 29, 3);
+        links.merge(names("\\Device\\PointerClass{}", 10, 19, 3));
+        expect(report.unapplied_links == links, "failure at a link: that link and the ones after it");
+    }
+
+    {
+        auto c = cfg;
+        auto report = run_fault_harness(c);
+        expect(report.n_failed == 0 && report.failures_by_status.empty(), "no faults: nothing fails");
+        expect(report.unapplied_devices.empty() && report.unapplied_links.empty(), "no faults: everything applied");
+    }
+
+    {
+        auto c = cfg;
+        c.faults.error_rate = 1.0;
+        c.faults.random_error_status = ntstatus::privilege_not_held;
+        auto report = run_fault_harness(c);
+        expect(report.failures_by_status == std::map<uint32_t, int>{ { ntstatus::privilege_not_held, 3 } }, "error rate 1: first call fails with the random status");
+        expect(report.unapplied_devices == names("\\Device\\Interception{:02}", 0, 4, 3), "error rate 1: no device applied");
+    }
+
+    return test_exit_code();
+}
@@ -0,0 +1,54 @@
+// Copyright (c) 2025 Hygor Ostrowskij de Morais <hygor.o.morais@gmail.com>
+
+// The \Device hash and chain model against known names, and the footprint of the default config.
+
+#include <string>
+#include <vector>
+#include "config.hpp"
+#include "footprint.hpp"
+#include "object_directory_model.hpp"
+#include "test_utils.hpp"
+
+
+using namespace hy;
+
+
+int main() {
+    // "AB": 'A' = 65, then 65 + (65 << 1) + (65 >> 1) + 'B' = 65 + 130 + 32 + 66 = 293, 293 % 37 = 34.
+    expect(object_directory_hash("A") == 65 && object_directory_bucket("A") == 28, "hash of A");
+    expect(object_directory_hash("AB") == 293 && object_directory_bucket("AB") == 34, "hash of AB");
+    expect(object_directory_hash("ab") == 293, "hash is case insensitive");
+    expect(object_directory_hash("KeyboardClass0") == 1230425531u && object_directory_bucket("KeyboardClass0") == 3, "hash of KeyboardClass0");
+    expect(object_directory_hash("KeyboardClass10") == 11522114u && object_directory_bucket("KeyboardClass10") == 18, "hash of KeyboardClass10");
+    expect(object_directory_hash("PointerClass0") == 375240648u && object_directory_bucket("PointerClass0") == 5, "hash of PointerClass0");
+    expect(object_directory_hash("Interception00") == 1233416088u && object_directory_bucket("Interception00") == 35, "hash of Interception00");
+    expect(object_directory_hash("00000034") == 432347u && object_directory_bucket("00000034") == 2, "hash of 00000034");
+
+    {
+        // A, CZ and DV all land in bucket 28.
+        ObjectDirectoryModel dir;
+        dir.insert("A");
+        dir.insert("CZ");
+        dir.insert("dv");
+        dir.insert("DV");
+        expect(dir.size() == 3 && dir.chain_length(28) == 3, "same bucket, one chain");
+        expect(dir.lookup_probes("dv") == 1 && dir.lookup_probes("CZ") == 2 && dir.lookup_probes("a") == 3, "new entries go to the head");
+        expect(dir.lookup_probes("ES") == 3, "a miss walks the whole chain");
+        dir.remove("cz");
+        expect(!dir.contains("CZ") && dir.chain_length(28) == 2 && dir.lookup_probes("A") == 2, "remove");
+    }
+
+    {
+        // KeyboardClass10-999 and PointerClass10-999.
+        auto cfg = default_main_config();
+        auto baseline = synthetic_device_baseline(300);
+        auto report = estimate_footprint(cfg, baseline);
+        expect(report.n_baseline_entries == 300 && report.n_added_entries == 1980, "default config adds 1980 entries");
+
+        baseline.push_back("KeyboardClass10");
+        report = estimate_footprint(cfg, baseline);
+        expect(report.n_baseline_entries == 301 && report.n_added_entries == 1979, "a name already in \\Device isn't added again");
+    }
+
+    return test_exit_code();
+}
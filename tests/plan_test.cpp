@@ -0,0 +1,105 @@
+// Copyright (c) 2025 Hygor Ostrowskij de Morais <hygor.o.morais@gmail.com>
+
+// SymlinkPlan against the nested loops real_main used before it, and resuming batches from any index.
+
+#include <string>
+#include <utility>
+#include <vector>
+#include <fmt/format.h>
+#include "config.hpp"
+#include "plan.hpp"
+#include "test_utils.hpp"
+
+
+using namespace hy;
+
+
+using NameTarget = std::pair<std::string, std::string>;
+
+
+// What real_main did before the plan existed, names and targets in order.
+static std::vector<NameTarget> old_loops(const AppMainConfig& cfg) {
+    std::vector<NameTarget> out;
+    for (int i = 0; i < cfg.n_max_interception_devices; i++) {
+        out.emplace_back(fmt::format("\\Device\\Interception{:02}", i), "");
+    }
+    for (int i = 10; i < cfg.n_keyboard_symlinks; i += 10) {
+        for (int j = 0; j < 10; j++) {
+            out.emplace_back(fmt::format("\\Device\\KeyboardClass{}", i+j), fmt::format("\\Device\\KeyboardClass{}", j));
+        }
+    }
+    for (int i = 10; i < cfg.n_pointer_symlinks; i += 10) {
+        for (int j = 0; j < 10; j++) {
+            out.emplace_back(fmt::format("\\Device\\PointerClass{}", i+j), fmt::format("\\Device\\PointerClass{}", j));
+        }
+    }
+    return out;
+}
+
+
+static std::vector<NameTarget> from_batches(SymlinkPlan::Batches batches, size_t* first_index = nullptr) {
+    std::vector<NameTarget> out;
+    for (auto batch : batches) {
+        for (auto& entry : batch) {
+            if (out.empty() && first_index) {
+                *first_index = entry.index;
+            }
+            out.emplace_back(entry.name, entry.target);
+        }
+    }
+    return out;
+}
+
+
+static std::vector<NameTarget> from_ops(const SymlinkPlan& plan) {
+    std::vector<NameTarget> out;
+    std::string name;
+    std::string target;
+    for (auto op : plan) {
+        op.format_name(name);
+        op.format_target(target);
+        out.emplace_back(name, target);
+    }
+    return out;
+}
+
+
+int main() {
+    for (int n_devices : { 0, 3, 20 }) {
+        for (auto [n_keyboard, n_pointer] : { std::pair{ 0, 0 }, { 10, 11 }, { 15, 1000 }, { 1000, 999 }, { 1234, 20 }, { -5, 101 } }) {
+            auto cfg = default_main_config();
+            cfg.n_max_interception_devices = n_devices;
+            cfg.n_keyboard_symlinks = n_keyboard;
+            cfg.n_pointer_symlinks = n_pointer;
+
+            auto expected = old_loops(cfg);
+            SymlinkPlan plan(cfg);
+            auto what = fmt::format("devices={} keyboard={} pointer={}", n_devices, n_keyboard, n_pointer);
+
+            expect(plan.size() == expected.size(), fmt::format("{}: size", what).c_str());
+            expect(from_ops(plan) == expected, fmt::format("{}: ops", what).c_str());
+            for (size_t batch_size : { 1, 7, 256 }) {
+                expect(from_batches(plan.batches(batch_size)) == expected, fmt::format("{}: batches of {}", what, batch_size).c_str());
+            }
+
+            for (size_t start : { size_t(0), size_t(9), plan.size() / 2, plan.size(), plan.size() + 5 }) {
+                size_t first_index = SIZE_MAX;
+                auto batches = plan.batches(7, start);
+                auto resumed = from_batches(std::move(batches), &first_index);
+                auto tail = std::vector<NameTarget>(expected.begin() + std::min(start, expected.size()), expected.end());
+                expect(resumed == tail, fmt::format("{}: resume at {}", what, start).c_str());
+                expect(tail.empty() || first_index == start, fmt::format("{}: first index when resuming at {}", what, start).c_str());
+            }
+        }
+    }
+
+    {
+        // Batches keep their own copy of the plan.
+        auto cfg = default_main_config();
+        auto batches = SymlinkPlan(cfg).batches(5, 3);
+        expect(batches.position() == 3, "position before the first batch");
+        expect(from_batches(std::move(batches)).size() == SymlinkPlan(cfg).size() - 3, "batches of a temporary plan");
+    }
+
+    return test_exit_code();
+}
@@ -0,0 +1,133 @@
+// Copyright (c) 2025 Hygor Ostrowskij de Morais <hygor.o.morais@gmail.com>
+
+// run_service through the simulated SCM: the status sequence for boot and demand starts, progress reports
+//   during a slow apply, and failures.
+
+#include <stdexcept>
+#include <spdlog/spdlog.h>
+#include <spdlog/sinks/null_sink.h>
+#include "config.hpp"
+#include "fault_backend.hpp"
+#include "service_control.hpp"
+#include "sim_backend.hpp"
+#include "sim_service_control.hpp"
+#include "test_utils.hpp"
+
+
+using namespace hy;
+
+
+static bool ever_in(const SimServiceControl& scm, ServiceState state) {
+    for (auto& event : scm.history()) {
+        if (event.report.state == state) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+// Every START_PENDING report has a wait hint, and each one after the first advances the checkpoint.
+static bool pending_reports_advance(const SimServiceControl& scm) {
+    auto& events = scm.history();
+    for (size_t i = 0; i < events.size(); i++) {
+        auto& r = events[i].report;
+        if (r.state != ServiceState::start_pending) {
+            continue;
+        }
+        if (r.wait_hint_ms == 0) {
+            return false;
+        }
+        if (i > 0 && events[i-1].report.state == ServiceState::start_pending && r.checkpoint <= events[i-1].report.checkpoint) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+int main() {
+    auto logger = std::make_shared<spdlog::logger>("service-control-test", std::make_shared<spdlog::sinks::null_sink_st>());
+    auto cfg = default_main_config();
+    cfg.n_keyboard_symlinks = 60;
+    cfg.n_pointer_symlinks = 60;
+
+    {
+        SimNamespace ns;
+        ns.add_default_devices(cfg.n_max_interception_devices);
+        SimNamespaceBackend backend(ns);
+        SimServiceControl scm(ServiceStartReason::auto_start);
+
+        auto exit_code = run_service(scm, [&] { return ServiceRunConfig{ cfg }; }, backend, *logger);
+        expect(exit_code == 0 && scm.stopped(), "boot start stops with exit code 0");
+        expect(scm.history().back().report.exit_code == 0, "boot start reports exit code 0");
+        expect(!ever_in(scm, ServiceState::running), "boot start never reports SERVICE_RUNNING");
+        expect(scm.history().size() >= 2 && scm.history()[scm.history().size() - 2].report.state == ServiceState::start_pending,
+            "boot start goes straight from SERVICE_START_PENDING to SERVICE_STOPPED");
+        expect(scm.time_to_stopped() < SERVICE_DEMAND_START_LINGER, "boot start doesn't linger");
+        expect(pending_reports_advance(scm), "boot start pending reports");
+    }
+
+    {
+        SimNamespace ns;
+        ns.add_default_devices(cfg.n_max_interception_devices);
+        SimNamespaceBackend backend(ns);
+        SimServiceControl scm(ServiceStartReason::demand);
+
+        auto exit_code = run_service(scm, [&] { return ServiceRunConfig{ cfg }; }, backend, *logger);
+        expect(exit_code == 0 && scm.stopped(), "demand start stops with exit code 0");
+        expect(ever_in(scm, ServiceState::running), "demand start reports SERVICE_RUNNING");
+        expect(scm.time_to_stopped() >= SERVICE_DEMAND_START_LINGER, "demand start lingers");
+    }
+
+    {
+        // 200 us per call over the default 2000 operations spans several progress intervals and plan batches.
+        auto slow_cfg = default_main_config();
+        SimNamespace ns;
+        ns.add_default_devices(slow_cfg.n_max_interception_devices);
+        SimNamespaceBackend sim(ns);
+        FaultConfig faults;
+        faults.latency.kind = LatencyDistribution::Kind::fixed;
+        faults.latency.a = std::chrono::microseconds(200);
+        FaultInjectingBackend backend(sim, faults);
+        SimServiceControl scm(ServiceStartReason::auto_start);
+
+        run_service(scm, [&] { return ServiceRunConfig{ slow_cfg }; }, backend, *logger);
+        expect(scm.stopped(), "slow apply stops");
+        expect(scm.history().size() >= 4, "slow apply reports progress");
+        expect(pending_reports_advance(scm), "slow apply checkpoints strictly increase with nonzero wait hints");
+        expect(scm.max_report_gap() < SERVICE_MIN_WAIT_HINT, "slow apply reports before its wait hint runs out");
+    }
+
+    {
+        SimNamespace ns;
+        ns.add_default_devices(cfg.n_max_interception_devices);
+        SimNamespaceBackend sim(ns);
+        FaultConfig faults;
+        faults.fail_at[25] = ntstatus::access_denied;
+        FaultInjectingBackend backend(sim, faults);
+        SimServiceControl scm(ServiceStartReason::demand);
+
+        auto exit_code = run_service(scm, [&] { return ServiceRunConfig{ cfg }; }, backend, *logger);
+        expect(scm.stopped(), "failed apply ends in SERVICE_STOPPED");
+        expect(exit_code != 0 && scm.history().back().report.exit_code == exit_code, "failed apply reports an error code");
+        expect(!ever_in(scm, ServiceState::running), "failed apply never reports SERVICE_RUNNING");
+    }
+
+    {
+        SimNamespace ns;
+        SimNamespaceBackend backend(ns);
+        SimServiceControl scm(ServiceStartReason::auto_start);
+
+        auto exit_code = run_service(scm, [&]() -> ServiceRunConfig { throw std::runtime_error("Unexpected arguments for service."); }, backend, *logger);
+        expect(scm.stopped() && exit_code != 0, "failed config load ends in SERVICE_STOPPED with an error code");
+    }
+
+    {
+        SimServiceControl scm(ServiceStartReason::auto_start);
+        expect(scm.control(service_control::interrogate) == SERVICE_NO_ERROR, "interrogate accepted");
+        expect(scm.control(service_control::stop) == SERVICE_CALL_NOT_IMPLEMENTED, "stop not accepted");
+    }
+
+    return test_exit_code();
+}
@@ -0,0 +1,106 @@
+// Copyright (c) 2025 Hygor Ostrowskij de Morais <hygor.o.morais@gmail.com>
+
+// install_service and uninstall_service through the simulated SCM: what gets written, when the service is started,
+//   and a service that's still running with a configuration that just changed.
+
+#include <chrono>
+#include <spdlog/spdlog.h>
+#include <spdlog/sinks/null_sink.h>
+#include "service_manager.hpp"
+#include "sim_service_manager.hpp"
+#include "test_utils.hpp"
+
+
+using namespace hy;
+
+
+int main() {
+    auto logger = std::make_shared<spdlog::logger>("service-manager-test", std::make_shared<spdlog::sinks::null_sink_st>());
+    auto desired = desired_service_config("C:\\Program Files\\Interception Driver Fix\\interception-driver-fix.exe");
+
+    {
+        SimServiceManager scm;
+        int n_starts = 0;
+        scm.on_start = [&] { n_starts++; };
+
+        auto result = install_service(scm, desired, false, *logger);
+        expect(result.created && result.started && n_starts == 1, "fresh install creates and starts");
+        expect(scm.installed == desired && scm.state == ServiceState::stopped, "fresh install config");
+        expect(scm.call_counts().create == 1 && scm.call_counts().change_config == 0, "fresh install writes once");
+        expect(scm.round_trips() == 8, "fresh install round trips");
+    }
+
+    {
+        SimServiceManager scm;
+        scm.installed = desired;
+
+        auto result = install_service(scm, desired, true, *logger);
+        expect(!result.created && result.n_fields_changed == 0 && !result.started, "same settings: nothing to do");
+        expect(scm.call_counts().create == 0 && scm.call_counts().change_config == 0 && scm.call_counts().start == 0, "same settings: zero writes, no start");
+        expect(scm.call_counts().total() == 1, "same settings: one query");
+    }
+
+    {
+        SimServiceManager scm;
+        scm.installed = desired;
+        scm.installed->binary_path = "C:\\Interception Driver Fix\\interception-driver-fix.exe";
+        scm.installed->description = "Old description.";
+
+        auto result = install_service(scm, desired, false, *logger);
+        expect(result.n_fields_changed == 2 && result.started, "changed fields counted");
+        expect(scm.installed == desired && scm.call_counts().change_config == 1, "changed fields written in one call");
+
+        auto update = diff_service_config(desired, *scm.installed);
+        expect(update.size() == 0, "nothing left to change");
+        scm.installed->start_type = 3;
+        update = diff_service_config(*scm.installed, desired);
+        expect(update.size() == 1 && update.start_type == SERVICE_START_TYPE_AUTO && !update.binary_path && !update.description, "only the changed field");
+    }
+
+    {
+        SimServiceManager scm;
+        scm.installed = desired;
+        scm.installed->binary_path = "C:\\Interception Driver Fix 1.0\\interception-driver-fix.exe";
+        scm.state = ServiceState::running;
+        scm.stops_after = std::chrono::seconds(3);
+
+        auto result = install_service(scm, desired, false, *logger);
+        expect(result.n_fields_changed == 1 && result.started && scm.installed == desired, "running with a changed config: started again once stopped");
+        expect(scm.call_counts().query_state >= 2 && scm.call_time() >= std::chrono::seconds(3), "running with a changed config: waited");
+    }
+
+    {
+        SimServiceManager scm;
+        scm.installed = desired;
+        scm.installed->binary_path = "C:\\Interception Driver Fix 1.0\\interception-driver-fix.exe";
+        scm.state = ServiceState::start_pending;
+
+        expect(throws([&] { install_service(scm, desired, false, *logger); }), "never stops with a changed config: fails");
+        expect(scm.call_counts().start == 0, "never stops with a changed config: not started");
+    }
+
+    {
+        SimServiceManager scm;
+        scm.installed = desired;
+        scm.state = ServiceState::running;
+
+        auto result = install_service(scm, desired, false, *logger);
+        expect(!result.started && scm.call_counts().start == 0 && scm.call_time() == std::chrono::nanoseconds(0), "running with the same config: left alone");
+    }
+
+    {
+        SimServiceManager scm;
+        expect(!uninstall_service(scm, *logger), "uninstall of a missing service returns false");
+        expect(scm.call_counts().total() == 1 && scm.call_counts().stop == 0 && scm.call_counts().remove == 0, "uninstall of a missing service is a no-op");
+    }
+
+    {
+        SimServiceManager scm;
+        scm.installed = desired;
+        scm.state = ServiceState::running;
+        expect(uninstall_service(scm, *logger) && !scm.installed, "uninstall stops and removes");
+        expect(scm.call_counts().stop == 1 && scm.call_counts().remove == 1, "uninstall calls");
+    }
+
+    return test_exit_code();
+}
@@ -0,0 +1,60 @@
+// Copyright (c) 2025 Hygor Ostrowskij de Morais <hygor.o.morais@gmail.com>
+
+// Simulated handles and security descriptors stay open until released, so the resource budgets catch a
+//   backend that forgets to close one, as they would on Windows.
+
+#include <spdlog/spdlog.h>
+#include <spdlog/sinks/null_sink.h>
+#include "config.hpp"
+#include "core.hpp"
+#include "instrumentation.hpp"
+#include "sim_backend.hpp"
+#include "test_utils.hpp"
+
+
+using namespace hy;
+
+
+static bool over_budget(const PhaseRecord& record) {
+    return throws([&] { expect_within_budget(record, ResourceBudget{}); });
+}
+
+
+int main() {
+    auto logger = std::make_shared<spdlog::logger>("sim-backend-test", std::make_shared<spdlog::sinks::null_sink_st>());
+    auto cfg = default_main_config();
+
+    SimNamespace ns;
+    ns.add_default_devices(cfg.n_max_interception_devices);
+    SimNamespaceBackend backend(ns);
+
+    {
+        PhaseScope phase("apply", logger.get());
+        apply(cfg, backend, *logger);
+        auto record = phase.finish();
+        expect(record.delta.handles_opened > 0, "apply opens handles");
+        expect(!over_budget(record), "apply closes everything it opens");
+    }
+    expect(ns.n_open_handles() == 0 && ns.n_open_descriptors() == 0, "nothing open after apply");
+
+    {
+        PhaseScope phase("leak", logger.get());
+        std::scoped_lock lock(ns.mutex);
+        auto handle = ns.open_handle();
+        auto record = phase.finish();
+        expect(over_budget(record), "a handle left open is over budget");
+        ns.close_handle(handle);
+        expect(throws([&] { ns.close_handle(handle); }), "closing a handle twice throws");
+    }
+
+    {
+        PhaseScope phase("leak", logger.get());
+        std::scoped_lock lock(ns.mutex);
+        auto psd = ns.create_descriptor();
+        auto record = phase.finish();
+        expect(over_budget(record), "a security descriptor left allocated is over budget");
+        ns.free_descriptor(psd);
+    }
+
+    return test_exit_code();
+}
@@ -0,0 +1,68 @@
+// Copyright (c) 2025 Hygor Ostrowskij de Morais <hygor.o.morais@gmail.com>
+
+// A service that dies mid-write leaves the status block sequence odd. Readers must give up instead of
+//   hanging, and the next apply must leave the block readable again. An apply only counts as current
+//   when this version did it with the same settings.
+
+#include <sys/mman.h>
+#include <interception_driver_fix.h>
+#include "status_block.hpp"
+#include "test_utils.hpp"
+
+
+using namespace hy;
+
+
+int main() {
+    shm_unlink(MY_STATUS_SHM_NAME);
+
+    {
+        auto mapping = StatusBlockMapping::open_or_create();
+        auto& block = *mapping.get();
+        StatusBlockWriter writer(block);
+
+        auto cfg = default_main_config();
+        writer.record_apply(cfg, 1, 2, 3, std::chrono::nanoseconds(4));
+        expect(read_status_block(block).has_value(), "snapshot after a complete write");
+
+        // Writer died between its two sequence stores.
+        block.sequence.store(7);
+        expect(!read_status_block(block).has_value(), "no snapshot while stuck mid-write");
+
+        idf_status_snapshot snapshot = {};
+        snapshot.size = sizeof(snapshot);
+        expect(idf_read_status(&snapshot) == IDF_NOT_AVAILABLE, "idf_read_status returns while stuck mid-write");
+
+        writer.record_apply(cfg, 5, 6, 7, std::chrono::nanoseconds(8));
+        expect((block.sequence.load() & 1) == 0, "sequence even again after the next write");
+        auto s = read_status_block(block);
+        expect(s && s->n_symlinks_created == 5, "snapshot after recovering");
+        expect(idf_read_status(&snapshot) == IDF_OK && snapshot.symlinks_created == 5, "idf_read_status after recovering");
+    }
+
+    shm_unlink(MY_STATUS_SHM_NAME);
+
+    {
+        auto cfg = default_main_config();
+
+        // A version 1 block, as an older service left it.
+        StatusBlockLayout block = {};
+        block.magic.store(STATUS_BLOCK_MAGIC);
+        block.version.store(1);
+        block.generation.store(1);
+        expect(!is_apply_current(block, cfg), "version 1 block is never current");
+
+        StatusBlockWriter older(block, app_version_hash("1.0"));
+        expect(block.version.load() == STATUS_BLOCK_VERSION, "writer upgrades the block version");
+        older.record_apply(cfg, 1, 0, 0, std::chrono::nanoseconds(1));
+        expect(!is_apply_current(block, cfg), "apply by another version isn't current");
+
+        StatusBlockWriter(block).record_apply(cfg, 0, 1, 0, std::chrono::nanoseconds(1));
+        expect(is_apply_current(block, cfg), "apply by this version is current");
+        auto changed = cfg;
+        changed.lockdown = !changed.lockdown;
+        expect(!is_apply_current(block, changed), "apply with other settings isn't current");
+    }
+
+    return test_exit_code();
+}
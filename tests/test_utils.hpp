@@ -0,0 +1,40 @@
+// Copyright (c) 2025 Hygor Ostrowskij de Morais <hygor.o.morais@gmail.com>
+
+#pragma once
+
+#include <cstdio>
+#include <exception>
+
+
+namespace hy {
+
+
+inline int test_failures = 0;
+
+
+// Records a failed check and keeps going, so one run reports every failure.
+inline void expect(bool condition, const char* what) {
+    if (!condition) {
+        std::fprintf(stderr, "FAILED: %s\n", what);
+        test_failures++;
+    }
+}
+
+
+template<typename F>
+bool throws(F&& f) {
+    try {
+        f();
+    } catch (const std::exception&) {
+        return true;
+    }
+    return false;
+}
+
+
+inline int test_exit_code() {
+    return test_failures ? 1 : 0;
+}
+
+
+}  // namespace
@@ -0,0 +1,110 @@
+// Copyright (c) 2025 Hygor Ostrowskij de Morais <hygor.o.morais@gmail.com>
+
+// verify against a simulated namespace that apply set up and that was then damaged in every way verify knows about,
+//   and the time it takes for 100k links.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <spdlog/spdlog.h>
+#include <spdlog/sinks/null_sink.h>
+#include "config.hpp"
+#include "core.hpp"
+#include "sim_backend.hpp"
+#include "test_utils.hpp"
+#include "verify.hpp"
+
+
+using namespace hy;
+
+
+// Release builds take ~0.15 s. Unoptimized builds are about four times slower and only get a looser check.
+#ifdef NDEBUG
+constexpr auto VERIFY_100K_BUDGET = std::chrono::milliseconds(500);
+#else
+constexpr auto VERIFY_100K_BUDGET = std::chrono::seconds(2);
+#endif
+
+
+static const VerifyIssue* find_issue(const std::vector<VerifyIssue>& issues, VerifyIssueKind kind, std::string_view name) {
+    auto it = std::find_if(issues.begin(), issues.end(), [&](auto& issue) { return issue.kind == kind && issue.name == name; });
+    return it == issues.end() ? nullptr : &*it;
+}
+
+
+static void make_symlink(SimNamespace& ns, const std::string& link, const std::string& target) {
+    ns.objects.insert_or_assign(link, SimObject{ ObjectType::symbolic_link, target, "" });
+}
+
+
+int main() {
+    auto logger = std::make_shared<spdlog::logger>("verify-test", std::make_shared<spdlog::sinks::null_sink_st>());
+
+    {
+        auto cfg = default_main_config();
+        cfg.n_keyboard_symlinks = 25;  // KeyboardClass10..29
+        cfg.n_pointer_symlinks = 15;   // PointerClass10..19
+
+        SimNamespace ns;
+        ns.add_default_devices(cfg.n_max_interception_devices);
+        SimNamespaceBackend backend(ns);
+        apply(cfg, backend, *logger);
+
+        auto clean = verify(cfg, backend);
+        expect(clean.ok() && verify_exit_code(clean) == 0, "nothing reported after apply");
+        expect(clean.n_links_checked == 30 && clean.n_devices_checked == 20, "everything checked");
+
+        backend.remove_symlink("\\Device\\KeyboardClass10");
+        make_symlink(ns, "\\Device\\KeyboardClass11", "\\Device\\KeyboardClass5");
+        make_symlink(ns, "\\Device\\KeyboardClass2", "\\Device\\KeyboardClass7");  // KeyboardClass12 -> KeyboardClass2 -> KeyboardClass7
+        ns.objects.insert_or_assign("\\Device\\KeyboardClass13", SimObject{ ObjectType::device, "", "" });
+        make_symlink(ns, "\\Device\\PointerClass0", "\\Device\\PointerClass10");  // PointerClass10 -> PointerClass0 -> PointerClass10 -> ...
+        backend.set_interception_device_permissions(3, "D:(A;;FA;;;WD)");
+        ns.objects.erase("\\Device\\Interception04");
+
+        auto report = verify(cfg, backend);
+        expect(!report.ok() && verify_exit_code(report) == 2, "issues reported, exit code 2");
+
+        auto missing = find_issue(report.issues, VerifyIssueKind::missing_link, "\\Device\\KeyboardClass10");
+        expect(missing && missing->expected == "\\Device\\KeyboardClass0", "missing link");
+
+        auto wrong = find_issue(report.issues, VerifyIssueKind::wrong_target, "\\Device\\KeyboardClass11");
+        expect(wrong && wrong->actual == "\\Device\\KeyboardClass5" && wrong->expected == "\\Device\\KeyboardClass1", "wrong target");
+
+        auto hop = find_issue(report.issues, VerifyIssueKind::multi_hop, "\\Device\\KeyboardClass12");
+        expect(hop && hop->actual == "\\Device\\KeyboardClass7" && hop->expected == "\\Device\\KeyboardClass2", "multi hop names where the chain ends");
+        expect(find_issue(report.issues, VerifyIssueKind::multi_hop, "\\Device\\KeyboardClass22"), "every link into the chain is multi hop");
+        expect(find_issue(report.issues, VerifyIssueKind::multi_hop, "\\Device\\PointerClass10"), "symlink loop reported as multi hop");
+
+        auto drift = find_issue(report.issues, VerifyIssueKind::dacl_drift, "\\Device\\Interception03");
+        expect(drift && drift->actual == "D:(A;;FA;;;WD)" && drift->expected == STANDARD_INTERCEPTION_SDDL, "DACL drift");
+
+        expect(find_issue(report.issues, VerifyIssueKind::missing_device, "\\Device\\Interception04"), "missing device");
+
+        expect(find_issue(report.notes, VerifyIssueKind::name_taken, "\\Device\\KeyboardClass13"), "name taken is a note");
+        expect(!find_issue(report.issues, VerifyIssueKind::name_taken, "\\Device\\KeyboardClass13"), "name taken is not an issue");
+
+        expect(report.issues.size() == 7, "nothing else reported");
+    }
+
+    {
+        auto cfg = default_main_config();
+        cfg.n_keyboard_symlinks = 50010;
+        cfg.n_pointer_symlinks = 50010;
+
+        SimNamespace ns;
+        ns.add_default_devices(cfg.n_max_interception_devices);
+        SimNamespaceBackend backend(ns);
+        apply(cfg, backend, *logger);
+
+        auto start = std::chrono::steady_clock::now();
+        auto report = verify(cfg, backend);
+        auto duration = std::chrono::steady_clock::now() - start;
+
+        expect(report.ok() && report.n_links_checked == 100000, "100k links verified");
+        std::printf("100k links verified in %.3f s\n", std::chrono::duration<double>(duration).count());
+        expect(duration < VERIFY_100K_BUDGET, "100k links within budget");
+    }
+
+    return test_exit_code();
+}